@@ -0,0 +1,320 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//Microbenchmarks for the hot paths of the analyser. Every benchmark is run for sizes from --min_size to --max_size,
+//multiplying the size by 10 each time, and reports the time per element.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <cstdlib>
+#include <unistd.h>
+#include "dataholder.h"
+#include "datahistogram.h"
+#include "mathutils.h"
+#include "inputtypes.h"
+#include "pipelinedreader.h"
+#include "distributions/distribution.h"
+#include "distributions/normaldistribution.h"
+#include "distributions/exponentialdistribution.h"
+#include "distributions/triangulardistribution.h"
+#include "distributions/lognormaldistribution.h"
+#include "distributions/tabulateddistribution.h"
+#include "distributions/poissondistribution.h"
+#include "distributions/uniformdistribution.h"
+
+#ifndef EXIT_FAILURE
+#define EXIT_FAILURE 1
+#endif
+
+#ifndef EXIT_SUCCESS
+#define EXIT_SUCCESS 0
+#endif
+
+using namespace std;
+
+namespace {
+    //Results are accumulated here so the compiler can't discard the benchmarked work.
+    volatile input_data_t sink = 0;
+    
+    /**
+     * A benchmark receives the size and returns the number of elements it processed while being timed.
+     * Setup that should not be measured is done before calling the timer.
+     */
+    typedef function<void(size_t, function<void(function<void()>)>)> benchmark_t;
+    
+    struct benchmark_entry {
+        string name;
+        benchmark_t run;
+    };
+    
+    vector<input_data_t> make_samples(size_t size) {
+        mt19937 mt(42);
+        normal_distribution<input_data_t> dist(10, 2);
+        vector<input_data_t> samples(size);
+        for(auto& value: samples) {
+            value = dist(mt);
+        }
+        return samples;
+    }
+    
+    string make_text(size_t size) {
+        ostringstream text;
+        text.precision(numeric_limits<input_data_t>::max_digits10);
+        for(input_data_t value: make_samples(size)) {
+            text << value << "\n";
+        }
+        return text.str();
+    }
+    
+    DataHolder make_holder(size_t size) {
+        vector<input_data_t> samples = make_samples(size);
+        return DataHolder(samples.begin(), samples.end());
+    }
+    
+    benchmark_t generate_benchmark(function<unique_ptr<Distribution>()> factory) {
+        return [factory](size_t size, function<void(function<void()>)> timed) {
+            unique_ptr<Distribution> dist = factory();
+            timed([&]() {
+                input_data_t sum = 0;
+                for(size_t i = 0; i < size; ++i) {
+                    sum += dist->generate_value();
+                }
+                sink = sum;
+            });
+        };
+    }
+    
+    benchmark_t create_distribution_benchmark(ScoreType score) {
+        return [score](size_t size, function<void(function<void()>)> timed) {
+            DataHolder holder = make_holder(size);
+            timed([&]() {
+                set<DistributionType> types;
+                auto result = create_distribution(holder, types, 0, score);
+                sink = result.second;
+            });
+        };
+    }
+    
+    vector<benchmark_entry> all_benchmarks() {
+        vector<benchmark_entry> benchmarks;
+        benchmarks.push_back({"parse", [](size_t size, function<void(function<void()>)> timed) {
+            string content = make_text(size);
+            timed([&]() {
+                istringstream input(content);
+                DataHolder holder;
+                //The extraction operator of DataHolder, for programs that read samples from a stream.
+                while(input.peek() != EOF) {
+                    input >> holder;
+                    if(input.fail()) {
+                        input.clear();
+                        input.ignore();
+                    }
+                }
+                sink = holder.mean();
+            });
+        }});
+        benchmarks.push_back({"read_pipelined", [](size_t size, function<void(function<void()>)> timed) {
+            string content = make_text(size);
+            //main reads input files through this reader, from their file descriptor.
+            char path[] = "/tmp/bench_input_analyser_XXXXXX";
+            int fd = mkstemp(path);
+            if(fd < 0 || write(fd, content.data(), content.size()) != static_cast<ssize_t>(content.size())) {
+                cerr << "Can't write the input of read_pipelined to " << path << "." << endl;
+                return;
+            }
+            unlink(path);
+            timed([&]() {
+                lseek(fd, 0, SEEK_SET);
+                DataHolder holder;
+                read_pipelined(fd, holder);
+                sink = holder.mean();
+            });
+            close(fd);
+        }});
+        benchmarks.push_back({"dataholder_insert", [](size_t size, function<void(function<void()>)> timed) {
+            vector<input_data_t> samples = make_samples(size);
+            timed([&]() {
+                DataHolder holder;
+                for(input_data_t value: samples) {
+                    holder << value;
+                }
+                sink = holder.variance();
+            });
+        }});
+        benchmarks.push_back({"histogram_build", [](size_t size, function<void(function<void()>)> timed) {
+            DataHolder holder = make_holder(size);
+            timed([&]() {
+                DataHistogram histogram = holder.generate_histogram();
+                sink = histogram.data_size();
+            });
+        }});
+        benchmarks.push_back({"histogram_generate_value", [](size_t size, function<void(function<void()>)> timed) {
+            DataHistogram histogram = make_holder(std::min(size, static_cast<size_t>(1000000))).generate_histogram();
+            timed([&]() {
+                input_data_t sum = 0;
+                for(size_t i = 0; i < size; ++i) {
+                    sum += histogram.generate_value();
+                }
+                sink = sum;
+            });
+        }});
+        benchmarks.push_back({"normal_generate_value", generate_benchmark([]() {
+            return unique_ptr<Distribution>(new NormalDistribution(10, 2));
+        })});
+        benchmarks.push_back({"exponential_generate_value", generate_benchmark([]() {
+            return unique_ptr<Distribution>(new ExponentialDistribution(0.5));
+        })});
+        benchmarks.push_back({"triangular_generate_value", generate_benchmark([]() {
+            return unique_ptr<Distribution>(new TriangularDistribution(0, 10, 7));
+        })});
+        benchmarks.push_back({"uniform_generate_value", generate_benchmark([]() {
+            return unique_ptr<Distribution>(new UniformDistribution(0, 10));
+        })});
+        benchmarks.push_back({"lognormal_generate_value", generate_benchmark([]() {
+            return unique_ptr<Distribution>(new LogNormalDistribution(1, 0.5));
+        })});
+        benchmarks.push_back({"tabulated_lognormal_generate_value", generate_benchmark([]() {
+            return unique_ptr<Distribution>(new TabulatedDistribution(make_shared<LogNormalDistribution>(1, 0.5)));
+        })});
+        benchmarks.push_back({"poisson_generate_value", generate_benchmark([]() {
+            return unique_ptr<Distribution>(new PoissonDistribution(4));
+        })});
+        //The size is the number of integrand evaluations, each call does about 100 of them.
+        benchmarks.push_back({"integral", [](size_t size, function<void(function<void()>)> timed) {
+            NormalDistribution dist(10, 2);
+            auto fx = [&dist](input_data_t x) {
+                return dist.frequency_for(x);
+            };
+            size_t calls = std::max(static_cast<size_t>(1), size / 100);
+            timed([&]() {
+                input_data_t sum = 0;
+                for(size_t i = 0; i < calls; ++i) {
+                    input_data_t lower = 4 + (i % 100) * 0.12;
+                    sum += integral(lower, lower + 0.12, fx);
+                }
+                sink = sum;
+            });
+        }});
+        benchmarks.push_back({"chi_squared_test", [](size_t size, function<void(function<void()>)> timed) {
+            DataHistogram histogram = make_holder(size).generate_histogram();
+            NormalDistribution dist(10, 2);
+            timed([&]() {
+                sink = chi_squared_test(histogram, dist);
+            });
+        }});
+        benchmarks.push_back({"create_distribution_chi_squared", create_distribution_benchmark(ScoreType::CHI_SQUARED)});
+        benchmarks.push_back({"create_distribution_aic", create_distribution_benchmark(ScoreType::AIC)});
+        benchmarks.push_back({"create_distribution_ks", create_distribution_benchmark(ScoreType::KOLMOGOROV_SMIRNOV)});
+        return benchmarks;
+    }
+    
+    bool parse_size(const string& str, size_t& size) {
+        try {
+            size_t next_position = 0;
+            //Accepts scientific notation, such as 1e9.
+            double value = stod(str, &next_position);
+            if(next_position != str.size() || value < 1) {
+                return false;
+            }
+            size = static_cast<size_t>(value);
+            return true;
+        }
+        catch(exception& e) {
+            return false;
+        }
+    }
+    
+    void print_help(ostream& os) {
+        os << "Microbenchmarks for the input analyser." << endl;
+        os << "--min_size number: smallest size to benchmark. Defaults to 1e3." << endl;
+        os << "--max_size number: biggest size to benchmark. Defaults to 1e6. Use 1e9 for the" << endl;
+        os << "full sweep, which needs about 8GB of memory per copy of the data." << endl;
+        os << "--filter text: only runs the benchmarks whose name contains text." << endl;
+        os << "--min_time seconds: repeats each benchmark until this time is reached." << endl;
+        os << "Defaults to 0.2." << endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t min_size = 1000;
+    size_t max_size = 1000000;
+    double min_time = 0.2;
+    string filter;
+    for(int i = 1; i < argc; ++i) {
+        string cur_arg(argv[i]);
+        if(cur_arg == "--help" || cur_arg == "-h") {
+            print_help(cout);
+            return EXIT_SUCCESS;
+        }
+        if(i + 1 == argc) {
+            cerr << "Missing value after " << cur_arg << "." << endl;
+            return EXIT_FAILURE;
+        }
+        string value(argv[++i]);
+        if(cur_arg == "--min_size" && parse_size(value, min_size)) {
+            continue;
+        }
+        if(cur_arg == "--max_size" && parse_size(value, max_size)) {
+            continue;
+        }
+        if(cur_arg == "--filter") {
+            filter = value;
+            continue;
+        }
+        if(cur_arg == "--min_time") {
+            min_time = atof(value.c_str());
+            continue;
+        }
+        cerr << "Invalid argument " << cur_arg << " " << value << "." << endl;
+        print_help(cerr);
+        return EXIT_FAILURE;
+    }
+    cout << "benchmark,size,iterations,total_seconds,ns_per_element" << endl;
+    for(auto& benchmark: all_benchmarks()) {
+        if(!filter.empty() && benchmark.name.find(filter) == string::npos) {
+            continue;
+        }
+        for(size_t size = min_size; size <= max_size; size *= 10) {
+            size_t iterations = 0;
+            double total = 0;
+            benchmark.run(size, [&](function<void()> body) {
+                //Repeats the body until the minimum time is reached, so small sizes get stable numbers.
+                do {
+                    auto start = chrono::steady_clock::now();
+                    body();
+                    total += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                    ++iterations;
+                } while(total < min_time);
+            });
+            cout << benchmark.name << "," << size << "," << iterations << "," << total << ",";
+            cout << total / iterations / size * 1e9 << endl;
+            if(size > numeric_limits<size_t>::max() / 10) {
+                break;
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,377 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+//End to end benchmark of the analyser. Samples are drawn from each distribution with known parameters and written as text and
+//binary inputs, then the input_analyser executable fits every file with each thread count. Every run reports its throughput, its
+//peak resident memory and how far the parameters it estimated for the true distribution are from the ones the samples were drawn from.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "randomengine.h"
+#include "distributions/distribution.h"
+#include "distributions/normaldistribution.h"
+#include "distributions/exponentialdistribution.h"
+#include "distributions/triangulardistribution.h"
+#include "distributions/lognormaldistribution.h"
+#include "distributions/poissondistribution.h"
+#include "distributions/uniformdistribution.h"
+
+#ifndef EXIT_FAILURE
+#define EXIT_FAILURE 1
+#endif
+
+#ifndef EXIT_SUCCESS
+#define EXIT_SUCCESS 0
+#endif
+
+using namespace std;
+
+namespace {
+    /**
+     * The result of running the analyser on one file.
+     */
+    struct run_result {
+        double seconds = 0;
+        
+        //In kilobytes, as reported by the kernel.
+        long peak_rss = 0;
+        
+        string best;
+        
+        //The parameters the analyser estimated for the distribution the samples were drawn from, empty if it wasn't a candidate.
+        vector<double> parameters;
+    };
+    
+    vector<shared_ptr<const Distribution>> ground_truth() {
+        return {
+            make_shared<UniformDistribution>(2, 10),
+            make_shared<TriangularDistribution>(1, 10, 7),
+            make_shared<NormalDistribution>(10, 2),
+            make_shared<LogNormalDistribution>(1, 0.5),
+            make_shared<ExponentialDistribution>(0.5),
+            make_shared<PoissonDistribution>(4)
+        };
+    }
+    
+    string file_name(const Distribution& dist) {
+        string name = dist.get_distribution_name();
+        for(char& c: name) {
+            if(c == ' ') {
+                c = '_';
+            }
+        }
+        return name;
+    }
+    
+    /**
+     * Writes size samples of dist, drawn with a fixed seed, so every version of the analyser is measured on the same data.
+     * The samples are generated in blocks, so sizes much bigger than the memory can be written.
+     */
+    bool write_dataset(const Distribution& dist, size_t size, bool binary, const string& path) {
+        ofstream os(path, binary ? ios::out | ios::binary : ios::out);
+        RandomEngine engine(42);
+        if(binary) {
+            //Header of the binary input format, see is_binary_input.
+            const char magic[4] = {'I', 'A', 'B', '1'};
+            uint32_t sample_size = sizeof(double);
+            uint64_t reserved = 0;
+            uint64_t count = size;
+            os.write(magic, sizeof(magic));
+            os.write(reinterpret_cast<const char*>(&sample_size), sizeof(sample_size));
+            os.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+            os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        }
+        else {
+            os.precision(numeric_limits<double>::max_digits10);
+        }
+        const size_t block_size = 1 << 16;
+        vector<double> block;
+        block.reserve(block_size);
+        for(size_t written = 0; written < size; written += block.size()) {
+            block.clear();
+            for(size_t i = written; i < size && block.size() < block_size; ++i) {
+                block.push_back(dist.generate_value(engine));
+            }
+            if(binary) {
+                os.write(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(double));
+            }
+            else {
+                for(double value: block) {
+                    os << value << '\n';
+                }
+            }
+        }
+        return static_cast<bool>(os.flush());
+    }
+    
+    template<typename T>
+    bool read_value(istream& is, T& value) {
+        return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+    
+    bool read_report_distribution(istream& is, string& name, vector<double>& parameters) {
+        uint32_t name_size = 0;
+        uint32_t parameter_count = 0;
+        double score = 0;
+        if(!read_value(is, name_size) || !read_value(is, parameter_count)) {
+            return false;
+        }
+        name.resize(name_size);
+        parameters.resize(parameter_count);
+        is.read(&name[0], name_size);
+        is.read(reinterpret_cast<char*>(parameters.data()), parameter_count * sizeof(double));
+        return read_value(is, score);
+    }
+    
+    /**
+     * Reads the distributions of a report in the binary format of src/fitreport.h. The arrays after them are not needed.
+     */
+    bool read_report(const string& path, const Distribution& truth, run_result& result) {
+        ifstream is(path, ios::binary);
+        char magic[4] = {};
+        uint32_t header[3] = {};
+        uint64_t counts[4] = {};
+        double statistics[7] = {};
+        if(!is.read(magic, sizeof(magic)) || memcmp(magic, "IAR1", sizeof(magic)) ||
+                !is.read(reinterpret_cast<char*>(header), sizeof(header)) || !is.read(reinterpret_cast<char*>(counts), sizeof(counts)) ||
+                !is.read(reinterpret_cast<char*>(statistics), sizeof(statistics))) {
+            return false;
+        }
+        vector<double> parameters;
+        if(!read_report_distribution(is, result.best, parameters)) {
+            return false;
+        }
+        for(uint32_t i = 0; i < header[1]; ++i) {
+            string name;
+            if(!read_report_distribution(is, name, parameters)) {
+                return false;
+            }
+            if(name == truth.get_distribution_name()) {
+                result.parameters = parameters;
+            }
+        }
+        return true;
+    }
+    
+    /**
+     * Runs the analyser on input with the given number of threads and waits for it, so the kernel reports the peak memory of that
+     * process alone.
+     */
+    bool run_analyser(const string& analyser, const string& input, const string& report, unsigned int threads, run_result& result) {
+        auto start = chrono::steady_clock::now();
+        pid_t pid = fork();
+        if(pid < 0) {
+            return false;
+        }
+        if(pid == 0) {
+            int null_fd = open("/dev/null", O_WRONLY);
+            if(null_fd >= 0) {
+                dup2(null_fd, STDOUT_FILENO);
+            }
+            string thread_count = to_string(threads);
+            execl(analyser.c_str(), analyser.c_str(), "-if", input.c_str(), "-j", thread_count.c_str(), "-fmt", "binary", "-of",
+                  report.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        int status = 0;
+        struct rusage usage;
+        if(wait4(pid, &status, 0, &usage) != pid) {
+            return false;
+        }
+        result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        result.peak_rss = usage.ru_maxrss;
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    
+    /**
+     * The biggest error of the estimated parameters, relative to the true ones.
+     */
+    double parameter_error(const Distribution& truth, const vector<double>& estimated) {
+        vector<input_data_t> expected = truth.parameters();
+        if(estimated.size() != expected.size()) {
+            return numeric_limits<double>::quiet_NaN();
+        }
+        double error = 0;
+        for(size_t i = 0; i < expected.size(); ++i) {
+            error = std::max(error, std::abs(estimated[i] - expected[i]) / std::abs(expected[i]));
+        }
+        return error;
+    }
+    
+    bool parse_size(const string& str, size_t& size) {
+        try {
+            size_t next_position = 0;
+            //Accepts scientific notation, such as 1e9.
+            double value = stod(str, &next_position);
+            if(next_position != str.size() || value < 1) {
+                return false;
+            }
+            size = static_cast<size_t>(value);
+            return true;
+        }
+        catch(exception& e) {
+            return false;
+        }
+    }
+    
+    bool parse_threads(const string& str, vector<unsigned int>& threads) {
+        threads.clear();
+        stringstream ss(str);
+        string item;
+        while(getline(ss, item, ',')) {
+            int count = atoi(item.c_str());
+            if(count < 1) {
+                return false;
+            }
+            threads.push_back(static_cast<unsigned int>(count));
+        }
+        return !threads.empty();
+    }
+    
+    void print_help(ostream& os) {
+        os << "End to end benchmark of the input analyser on data with known parameters." << endl;
+        os << "--analyser file: the input_analyser executable to measure. Required." << endl;
+        os << "--min_size number: smallest sample count. Defaults to 1e4." << endl;
+        os << "--max_size number: biggest sample count. Defaults to 1e6. Use 1e9 for the" << endl;
+        os << "full sweep, which needs about 20GB of disk for the text files." << endl;
+        os << "--threads list: comma separated thread counts for each file. Defaults to 1" << endl;
+        os << "and the number of hardware threads." << endl;
+        os << "--data_dir dir: where the data sets are written. Each one is removed once" << endl;
+        os << "measured. Defaults to the current directory." << endl;
+        os << "--filter text: only uses the distributions whose name contains text." << endl;
+        os << "--output file: writes the CSV to file instead of the standard output." << endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t min_size = 10000;
+    size_t max_size = 1000000;
+    vector<unsigned int> threads = {1};
+    string analyser;
+    string data_dir = ".";
+    string filter;
+    string output_name;
+    unsigned int hardware_threads = thread::hardware_concurrency();
+    if(hardware_threads > 1) {
+        threads.push_back(hardware_threads);
+    }
+    for(int i = 1; i < argc; ++i) {
+        string cur_arg(argv[i]);
+        if(cur_arg == "--help" || cur_arg == "-h") {
+            print_help(cout);
+            return EXIT_SUCCESS;
+        }
+        if(i + 1 == argc) {
+            cerr << "Missing value after " << cur_arg << "." << endl;
+            return EXIT_FAILURE;
+        }
+        string value(argv[++i]);
+        if(cur_arg == "--analyser") {
+            analyser = value;
+            continue;
+        }
+        if(cur_arg == "--min_size" && parse_size(value, min_size)) {
+            continue;
+        }
+        if(cur_arg == "--max_size" && parse_size(value, max_size)) {
+            continue;
+        }
+        if(cur_arg == "--threads" && parse_threads(value, threads)) {
+            continue;
+        }
+        if(cur_arg == "--data_dir") {
+            data_dir = value;
+            continue;
+        }
+        if(cur_arg == "--filter") {
+            filter = value;
+            continue;
+        }
+        if(cur_arg == "--output") {
+            output_name = value;
+            continue;
+        }
+        cerr << "Invalid argument " << cur_arg << " " << value << "." << endl;
+        print_help(cerr);
+        return EXIT_FAILURE;
+    }
+    if(analyser.empty()) {
+        cerr << "Missing --analyser." << endl;
+        print_help(cerr);
+        return EXIT_FAILURE;
+    }
+    ofstream output_file;
+    if(!output_name.empty()) {
+        output_file.open(output_name);
+    }
+    ostream& output = output_name.empty() ? cout : output_file;
+    output << "distribution,format,size,threads,seconds,samples_per_second,peak_rss_kb,best,parameter_error" << endl;
+    int failures = 0;
+    for(auto& truth: ground_truth()) {
+        if(!filter.empty() && truth->get_distribution_name().find(filter) == string::npos) {
+            continue;
+        }
+        for(size_t size = min_size; size <= max_size; size *= 10) {
+            for(bool binary: {false, true}) {
+                string format = binary ? "binary" : "text";
+                string data_name = data_dir + "/" + file_name(*truth) + "_" + to_string(size) + "." + (binary ? "bin" : "txt");
+                string report_name = data_name + ".report";
+                if(!write_dataset(*truth, size, binary, data_name)) {
+                    cerr << "Error writing " << data_name << "." << endl;
+                    remove(data_name.c_str());
+                    return EXIT_FAILURE;
+                }
+                for(unsigned int thread_count: threads) {
+                    run_result result;
+                    if(!run_analyser(analyser, data_name, report_name, thread_count, result) || !read_report(report_name, *truth, result)) {
+                        cerr << "The analyser failed on " << data_name << " with " << thread_count << " threads." << endl;
+                        ++failures;
+                        continue;
+                    }
+                    output << truth->get_distribution_name() << "," << format << "," << size << "," << thread_count << ",";
+                    output << result.seconds << "," << size / result.seconds << "," << result.peak_rss << ",";
+                    output << result.best << "," << parameter_error(*truth, result.parameters) << endl;
+                }
+                remove(report_name.c_str());
+                remove(data_name.c_str());
+            }
+            if(size > numeric_limits<size_t>::max() / 10) {
+                break;
+            }
+        }
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,48 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//This file is only linked into the executables, never into input_analyser_core, so embedding the library doesn't replace
+//the allocator of the host program.
+
+#include "profiler.h"
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+//Replacing the global operator new is the only portable way of counting allocations without a profiler attached.
+//The array, nothrow and delete forms in the standard library all end up here or in free, so these are enough.
+void* operator new(size_t size) {
+    if(profile_counters::profiling_enabled.load(memory_order_relaxed)) {
+        profile_counters::allocations.fetch_add(1, memory_order_relaxed);
+        profile_counters::allocated_bytes.fetch_add(size, memory_order_relaxed);
+    }
+    void* ptr = malloc(size ? size : 1);
+    if(!ptr) {
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
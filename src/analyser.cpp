@@ -0,0 +1,66 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "analyser.h"
+#include <limits>
+#include <utility>
+
+using namespace std;
+
+InputAnalyser::InputAnalyser(AnalyserSettings settings, DataHolder data): _settings(move(settings)), _data(move(data)) {}
+
+void InputAnalyser::feed(const input_data_t* first, const input_data_t* last) {
+    lock_guard<mutex> lock(_mutex);
+    while(first != last) {
+        _data << *first++;
+    }
+}
+
+void InputAnalyser::feed(input_data_t value) {
+    lock_guard<mutex> lock(_mutex);
+    _data << value;
+}
+
+FitResult InputAnalyser::fit(Profiler* profiler) const {
+    lock_guard<mutex> lock(_mutex);
+    FitResult result = {nullptr, numeric_limits<input_data_t>::quiet_NaN(), {}};
+    if(!_data.data_size()) {
+        return result;
+    }
+    unique_ptr<Distribution> best;
+    tie(best, result.score) = create_distribution(_data, _settings.distributions, _settings.class_count, _settings.score,
+                                                  _settings.estimation, _settings.max_iterations, profiler, &result.candidates);
+    result.distribution = move(best);
+    return result;
+}
+
+size_t InputAnalyser::data_size() const {
+    lock_guard<mutex> lock(_mutex);
+    return _data.data_size();
+}
+
+SampleMoments InputAnalyser::moments() const {
+    lock_guard<mutex> lock(_mutex);
+    return _data.moments();
+}
+
+void generate_values(const Distribution& dist, input_data_t* first, input_data_t* last, RandomEngine& engine) {
+    while(first != last) {
+        *first++ = dist.generate_value(engine);
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANALYSER_H
+#define ANALYSER_H
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <cstddef>
+#include "dataholder.h"
+#include "inputtypes.h"
+#include "profiler.h"
+#include "randomengine.h"
+#include "distributions/distribution.h"
+
+/**
+ * Settings of a fit. The defaults are the same ones used by the command line.
+ */
+struct AnalyserSettings {
+    /**
+     * The candidate distributions. If empty, every type is tested.
+     */
+    std::set<DistributionType> distributions;
+    
+    /**
+     * The desired number of histogram classes, 0 to pick it from the sample size.
+     */
+    std::size_t class_count = 0;
+    
+    /**
+     * The criterion used to rank the candidates.
+     */
+    ScoreType score = ScoreType::CHI_SQUARED;
+    
+    /**
+     * The method used to estimate the parameters.
+     */
+    EstimationMethod estimation = EstimationMethod::MOMENTS;
+    
+    /**
+     * The maximum number of iterations of the estimators that have no closed form.
+     */
+    std::size_t max_iterations = 100;
+};
+
+/**
+ * Result of a fit.
+ */
+struct FitResult {
+    /**
+     * The best distribution. It is immutable and its generators only use the engine they receive, so it can be shared
+     * among threads. It is null if there was no data to fit.
+     */
+    std::shared_ptr<const Distribution> distribution;
+    
+    /**
+     * The score of the best distribution, using the criterion of the settings.
+     */
+    input_data_t score;
+    
+    /**
+     * Every candidate tested, with its score.
+     */
+    std::vector<CandidateScore> candidates;
+};
+
+/**
+ * Embeddable entry point of the analyser. An object owns its samples and its settings, there is no global state involved,
+ * so any number of objects can be used concurrently. A single object is also safe to share: every method locks it.
+ */
+class InputAnalyser {
+public:
+    //Constructors
+    
+    /**
+     * Constructs an object.
+     * @param settings The settings used by fit.
+     * @param data Initial samples.
+     */
+    explicit InputAnalyser(AnalyserSettings settings = AnalyserSettings(), DataHolder data = DataHolder());
+    
+    InputAnalyser(const InputAnalyser&) = delete;
+    InputAnalyser& operator=(const InputAnalyser&) = delete;
+    
+    /**
+     * Adds samples.
+     * @param first Pointer to the first sample.
+     * @param last Pointer to one past the last sample.
+     */
+    void feed(const input_data_t* first, const input_data_t* last);
+    
+    /**
+     * Adds one sample.
+     * @param value The sample.
+     */
+    void feed(input_data_t value);
+    
+    /**
+     * Fits the samples fed so far.
+     * @param profiler If not null, receives the time of each phase of the fit. It must not be shared with other threads.
+     * @return The best distribution and its score.
+     */
+    FitResult fit(Profiler* profiler = nullptr) const;
+    
+    /**
+     * Returns the amount of samples fed so far.
+     * @return The sample size.
+     */
+    std::size_t data_size() const;
+    
+    /**
+     * Returns a copy of the running statistics of the samples.
+     * @return The moments of the samples.
+     */
+    SampleMoments moments() const;
+    
+    /**
+     * Gives access to the samples. The reference is only valid while no other thread feeds this object.
+     * @return The samples.
+     */
+    const DataHolder& data() const {
+        return _data;
+    }
+    
+    /**
+     * Gets the settings.
+     * @return The settings used by fit.
+     */
+    const AnalyserSettings& settings() const {
+        return _settings;
+    }
+    
+private:
+    AnalyserSettings _settings;
+    
+    DataHolder _data;
+    
+    mutable std::mutex _mutex;
+};
+
+/**
+ * Fills a caller supplied buffer with random values of a distribution.
+ * @param dist The distribution.
+ * @param first Pointer to the first position of the buffer.
+ * @param last Pointer to one past the last position of the buffer.
+ * @param engine The random engine to draw from. Each thread should use its own.
+ */
+void generate_values(const Distribution& dist, input_data_t* first, input_data_t* last, RandomEngine& engine);
+
+#endif // ANALYSER_H
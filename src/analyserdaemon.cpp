@@ -0,0 +1,409 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "analyserdaemon.h"
+#include <map>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <sstream>
+#include <limits>
+#include <atomic>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "datasummary.h"
+
+using namespace std;
+
+namespace {
+    //Resolution of the first batch of a dataset on its warm histogram, and the most classes the histogram may grow to before its
+    //classes are merged in pairs.
+    const size_t grid_classes = 4096;
+    
+    const size_t max_grid_classes = 1 << 16;
+    
+    /**
+     * Returns the histogram with classes twice as wide, on the grid of the multiples of the new width.
+     */
+    DataHistogram widened(const DataHistogram& histogram) {
+        input_data_t width = histogram.class_width() * 2;
+        input_data_t lower = floor(histogram.begin()->lower_bound / width) * width;
+        vector<size_t> counts;
+        for(auto& klass : histogram) {
+            size_t index = static_cast<size_t>(floor((klass.lower_bound + histogram.class_width() / 2 - lower) / width));
+            counts.resize(std::max(counts.size(), index + 1), 0);
+            counts[index] += klass.class_count;
+        }
+        return DataHistogram::with_counts(lower, width, counts);
+    }
+    
+    /**
+     * Adds a batch of samples to a fixed edge histogram. The first batch sets the width of the classes, and the classes are
+     * widened when the data spreads too far for max_grid_classes of them.
+     */
+    void add_to_grid(DataHistogram& histogram, const input_data_t* first, const input_data_t* last) {
+        if(first == last) {
+            return;
+        }
+        auto min_max = minmax_element(first, last);
+        input_data_t min = *min_max.first, max = *min_max.second;
+        if(!histogram.is_mergeable()) {
+            input_data_t range = max > min ? max - min : std::max(abs(min), static_cast<input_data_t>(1.0));
+            histogram = DataHistogram::on_grid(first, last, range / grid_classes);
+            return;
+        }
+        min = std::min(min, histogram.begin()->lower_bound);
+        max = std::max(max, (histogram.end() - 1)->upper_bound);
+        while((max - min) / histogram.class_width() > max_grid_classes) {
+            histogram = widened(histogram);
+        }
+        histogram.merge(DataHistogram::on_grid(first, last, histogram.class_width()));
+    }
+    
+    /**
+     * A dataset, the summary kept warm as its samples arrive, and the last fit computed for it.
+     */
+    struct dataset {
+        dataset(const AnalyserSettings& settings): analyser(settings), fit_version(0), version(0) {}
+        
+        InputAnalyser analyser;
+        
+        //Guards grid, which is updated by every APPEND.
+        mutex grid_mutex;
+        
+        DataHistogram grid;
+        
+        mutex fit_mutex;
+        
+        FitResult last_fit;
+        
+        //The fit is reused while fit_version == version.
+        size_t fit_version;
+        
+        atomic<size_t> version;
+    };
+    
+    class daemon_state {
+    public:
+        daemon_state(const AnalyserSettings& settings): _settings(settings), _stopping(false) {}
+        
+        shared_ptr<dataset> find(uint64_t id, bool create) {
+            lock_guard<mutex> lock(_mutex);
+            auto it = _datasets.find(id);
+            if(it != _datasets.end()) {
+                return it->second;
+            }
+            if(!create) {
+                return nullptr;
+            }
+            shared_ptr<dataset> created = make_shared<dataset>(_settings);
+            _datasets[id] = created;
+            return created;
+        }
+        
+        void erase(uint64_t id) {
+            lock_guard<mutex> lock(_mutex);
+            _datasets.erase(id);
+        }
+        
+        atomic<bool>& stopping() {
+            return _stopping;
+        }
+        
+        /**
+         * Registers the socket of a connection being served, so shutdown_connections can interrupt it.
+         * @return false if the daemon is stopping, in which case the connection must not be served.
+         */
+        bool open_connection(int fd) {
+            lock_guard<mutex> lock(_mutex);
+            if(_stopping) {
+                return false;
+            }
+            _connections.insert(fd);
+            return true;
+        }
+        
+        void close_connection(int fd) {
+            lock_guard<mutex> lock(_mutex);
+            _connections.erase(fd);
+        }
+        
+        /**
+         * Stops the daemon. Connections being served see the end of their input, so their threads return.
+         */
+        void shutdown_connections() {
+            lock_guard<mutex> lock(_mutex);
+            _stopping = true;
+            for(int fd : _connections) {
+                shutdown(fd, SHUT_RDWR);
+            }
+        }
+        
+    private:
+        AnalyserSettings _settings;
+        
+        mutex _mutex;
+        
+        map<uint64_t, shared_ptr<dataset>> _datasets;
+        
+        set<int> _connections;
+        
+        atomic<bool> _stopping;
+    };
+    
+    bool read_all(int fd, void* buffer, size_t size) {
+        char* ptr = static_cast<char*>(buffer);
+        while(size) {
+            ssize_t got = read(fd, ptr, size);
+            if(got < 0 && errno == EINTR) {
+                continue;
+            }
+            if(got <= 0) {
+                return false;
+            }
+            ptr += got;
+            size -= got;
+        }
+        return true;
+    }
+    
+    bool write_all(int fd, const void* buffer, size_t size) {
+        const char* ptr = static_cast<const char*>(buffer);
+        while(size) {
+            ssize_t sent = write(fd, ptr, size);
+            if(sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if(sent <= 0) {
+                return false;
+            }
+            ptr += sent;
+            size -= sent;
+        }
+        return true;
+    }
+    
+    bool respond(int fd, uint32_t status, const void* payload, size_t size) {
+        response_header header = {status, 0, size};
+        return write_all(fd, &header, sizeof(header)) && write_all(fd, payload, size);
+    }
+    
+    bool respond_error(int fd, const string& message) {
+        return respond(fd, 1, message.data(), message.size());
+    }
+    
+    /**
+     * Gets the current fit of a dataset, computing it only if samples arrived since the last one. With the Chi Squared test and the
+     * moment estimates, the fit only needs the moments and the warm histogram, so it doesn't depend on the number of samples.
+     */
+    FitResult current_fit(dataset& data) {
+        lock_guard<mutex> lock(data.fit_mutex);
+        size_t version = data.version;
+        if(data.last_fit.distribution && data.fit_version == version) {
+            return data.last_fit;
+        }
+        const AnalyserSettings& settings = data.analyser.settings();
+        if(settings.score != ScoreType::CHI_SQUARED || settings.estimation != EstimationMethod::MOMENTS) {
+            data.last_fit = data.analyser.fit();
+            data.fit_version = version;
+            return data.last_fit;
+        }
+        SampleMoments moments;
+        DataHistogram histogram;
+        {
+            //APPEND feeds the samples and the grid under this lock, so both describe the same samples.
+            lock_guard<mutex> grid_lock(data.grid_mutex);
+            moments = data.analyser.moments();
+            //The same class count a fit of the samples would pick.
+            size_t classes = settings.class_count ? settings.class_count : static_cast<size_t>(sqrt(moments.count()));
+            histogram = data.grid.coarsened(std::max<size_t>(classes, 1));
+            version = data.version;
+        }
+        FitResult result = {nullptr, numeric_limits<input_data_t>::quiet_NaN(), {}};
+        if(moments.count()) {
+            unique_ptr<Distribution> best;
+            tie(best, result.score) = create_distribution(DataSummary(moments, histogram), settings.distributions);
+            result.distribution = move(best);
+        }
+        data.last_fit = result;
+        data.fit_version = version;
+        return data.last_fit;
+    }
+    
+    /**
+     * Serves one connection until the peer closes it.
+     * @return true if the connection asked for a shutdown.
+     */
+    bool serve(int fd, daemon_state& state) {
+        request_header header;
+        vector<input_data_t> buffer;
+        while(read_all(fd, &header, sizeof(header))) {
+            if(header.magic != daemon_magic) {
+                respond_error(fd, "bad magic number");
+                return false;
+            }
+            //Bounds what a single frame can make us allocate.
+            const uint64_t max_count = (1ull << 30) / sizeof(input_data_t);
+            if(header.count > max_count) {
+                respond_error(fd, "frame too big");
+                return false;
+            }
+            bool ok = true;
+            switch(static_cast<DaemonCommand>(header.command)) {
+                case(DaemonCommand::APPEND): {
+                    buffer.resize(header.count);
+                    if(!read_all(fd, buffer.data(), buffer.size() * sizeof(input_data_t))) {
+                        return false;
+                    }
+                    //The warm histogram needs finite samples to place them in a class.
+                    if(!all_of(buffer.begin(), buffer.end(), [](input_data_t value) { return std::isfinite(value); })) {
+                        ok = respond_error(fd, "samples must be finite");
+                        break;
+                    }
+                    shared_ptr<dataset> data = state.find(header.dataset_id, true);
+                    {
+                        lock_guard<mutex> lock(data->grid_mutex);
+                        data->analyser.feed(buffer.data(), buffer.data() + buffer.size());
+                        add_to_grid(data->grid, buffer.data(), buffer.data() + buffer.size());
+                        ++data->version;
+                    }
+                    ok = respond(fd, 0, nullptr, 0);
+                    break;
+                }
+                case(DaemonCommand::FIT): {
+                    shared_ptr<dataset> data = state.find(header.dataset_id, false);
+                    if(!data) {
+                        ok = respond_error(fd, "unknown dataset");
+                        break;
+                    }
+                    FitResult fit = current_fit(*data);
+                    if(!fit.distribution) {
+                        ok = respond_error(fd, "empty dataset");
+                        break;
+                    }
+                    ostringstream text;
+                    text.precision(numeric_limits<input_data_t>::max_digits10);
+                    text << fit.distribution->get_distribution_name() << "\n" << fit.distribution->get_parameters_str() << "\n" << fit.score << "\n";
+                    string payload = text.str();
+                    ok = respond(fd, 0, payload.data(), payload.size());
+                    break;
+                }
+                case(DaemonCommand::GENERATE): {
+                    shared_ptr<dataset> data = state.find(header.dataset_id, false);
+                    if(!data) {
+                        ok = respond_error(fd, "unknown dataset");
+                        break;
+                    }
+                    FitResult fit = current_fit(*data);
+                    if(!fit.distribution) {
+                        ok = respond_error(fd, "empty dataset");
+                        break;
+                    }
+                    buffer.resize(header.count);
+                    generate_values(*fit.distribution, buffer.data(), buffer.data() + buffer.size(), thread_random_engine());
+                    ok = respond(fd, 0, buffer.data(), buffer.size() * sizeof(input_data_t));
+                    break;
+                }
+                case(DaemonCommand::RESET): {
+                    state.erase(header.dataset_id);
+                    ok = respond(fd, 0, nullptr, 0);
+                    break;
+                }
+                case(DaemonCommand::SHUTDOWN): {
+                    respond(fd, 0, nullptr, 0);
+                    return true;
+                }
+                default: {
+                    respond_error(fd, "unknown command");
+                    return false;
+                }
+            }
+            if(!ok) {
+                return false;
+            }
+        }
+        return false;
+    }
+}
+
+int run_daemon(const string& socket_path, const AnalyserSettings& settings) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(socket_path.size() >= sizeof(address.sun_path)) {
+        cerr << "Socket path " << socket_path << " is too long." << endl;
+        return 1;
+    }
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0) {
+        cerr << "Error creating socket: " << strerror(errno) << "." << endl;
+        return 1;
+    }
+    unlink(socket_path.c_str());
+    //The datasets are private to the user running the daemon, so the socket is closed to everybody else before it accepts anything.
+    if(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || chmod(socket_path.c_str(), S_IRUSR | S_IWUSR) < 0 ||
+       listen(listener, SOMAXCONN) < 0) {
+        cerr << "Error listening on " << socket_path << ": " << strerror(errno) << "." << endl;
+        close(listener);
+        unlink(socket_path.c_str());
+        return 1;
+    }
+    daemon_state state(settings);
+    //Each thread accepts and serves one connection at a time, so at most daemon_connections are served at once and the others
+    //wait in the listen queue. The threads are joined, so no connection outlives the state.
+    vector<thread> workers;
+    for(size_t i = 0; i < daemon_connections; ++i) {
+        workers.emplace_back([&state, listener]() {
+            while(!state.stopping()) {
+                int client = accept(listener, nullptr, nullptr);
+                if(client < 0) {
+                    if(errno == EINTR || errno == ECONNABORTED) {
+                        continue;
+                    }
+                    return;
+                }
+                if(state.open_connection(client)) {
+                    bool shutdown_requested = serve(client, state);
+                    state.close_connection(client);
+                    if(shutdown_requested) {
+                        //Unblocks the other connections and the threads waiting in accept.
+                        state.shutdown_connections();
+                        shutdown(listener, SHUT_RDWR);
+                    }
+                }
+                close(client);
+            }
+        });
+    }
+    for(thread& worker : workers) {
+        worker.join();
+    }
+    close(listener);
+    unlink(socket_path.c_str());
+    return 0;
+}
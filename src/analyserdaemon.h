@@ -0,0 +1,114 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANALYSERDAEMON_H
+#define ANALYSERDAEMON_H
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "analyser.h"
+
+//Long running analysis server over a Unix domain socket.
+//
+//Every request is a request_header followed by its payload. Numbers use the native byte order, since the socket is local.
+//Every request gets a response_header followed by response_header::payload_size bytes of payload.
+//
+//  APPEND    payload: count samples, as input_data_t. Response payload: none. Adds the samples to the dataset. They must
+//            be finite.
+//  FIT       payload: none. Response payload: the text "name\nparameters\nscore\n". Fits the dataset, reusing the last
+//            fit if no sample arrived since. With the Chi Squared test and the moment estimates, the fit uses the moments and a
+//            fixed edge histogram updated by each APPEND, so it doesn't revisit the samples. Its classes are merged from that
+//            histogram, so the score is close to, but not exactly, the one of a fit of the samples.
+//  GENERATE  payload: none. Response payload: count random values, as input_data_t, from the dataset's current fit.
+//  RESET     payload: none. Response payload: none. Forgets the dataset.
+//  SHUTDOWN  payload: none. Response payload: none. Stops accepting connections and returns from run_daemon.
+
+/**
+ * Commands understood by the daemon.
+ */
+enum class DaemonCommand: std::uint32_t {
+    APPEND = 1,
+    FIT = 2,
+    GENERATE = 3,
+    RESET = 4,
+    SHUTDOWN = 5
+};
+
+/**
+ * Header of every request.
+ */
+struct request_header {
+    /**
+     * Must be daemon_magic.
+     */
+    std::uint32_t magic;
+    
+    /**
+     * One of DaemonCommand.
+     */
+    std::uint32_t command;
+    
+    /**
+     * Identifies the dataset. Datasets are created on their first APPEND.
+     */
+    std::uint64_t dataset_id;
+    
+    /**
+     * Number of samples sent by APPEND or requested by GENERATE.
+     */
+    std::uint64_t count;
+};
+
+/**
+ * Header of every response.
+ */
+struct response_header {
+    /**
+     * 0 on success. Otherwise the payload is an error message.
+     */
+    std::uint32_t status;
+    
+    std::uint32_t reserved;
+    
+    /**
+     * Size of the payload, in bytes.
+     */
+    std::uint64_t payload_size;
+};
+
+/**
+ * Magic number that starts every request ("IAD1").
+ */
+const std::uint32_t daemon_magic = 0x31444149;
+
+/**
+ * Maximum number of connections served at once. Further connections wait until one of them closes.
+ */
+const std::size_t daemon_connections = 32;
+
+/**
+ * Listens on a Unix domain socket and serves requests until a SHUTDOWN arrives. Each connection is served by its own thread
+ * and can send any number of requests. Datasets are shared among connections.
+ * @param socket_path Path of the socket. An existing file at this path is replaced. Only the user running the daemon can
+ * connect to it.
+ * @param settings Settings used by every fit.
+ * @return 0 after a SHUTDOWN, or a non zero value if the socket can't be created.
+ */
+int run_daemon(const std::string& socket_path, const AnalyserSettings& settings);
+
+#endif // ANALYSERDAEMON_H
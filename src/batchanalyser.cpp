@@ -0,0 +1,183 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "batchanalyser.h"
+#include <fstream>
+#include <limits>
+#include <glob.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include "pipelinedreader.h"
+#include "taskpool.h"
+
+using namespace std;
+
+namespace {
+    struct batch_record {
+        size_t samples = 0;
+        
+        string distribution;
+        
+        string parameters;
+        
+        input_data_t score = numeric_limits<input_data_t>::quiet_NaN();
+    };
+    
+    void analyse_data(DataHolder data, const AnalyserSettings& settings, batch_record& record) {
+        record.samples = data.sample_count();
+        if(!record.samples) {
+            record.distribution = "error";
+            record.parameters = "no data";
+            return;
+        }
+        InputAnalyser analyser(settings, move(data));
+        FitResult fit = analyser.fit();
+        record.distribution = fit.distribution->get_distribution_name();
+        record.parameters = fit.distribution->get_parameters_str();
+        record.score = fit.score;
+    }
+    
+    void analyse_file(const string& name, const AnalyserSettings& settings, batch_record& record) {
+        ifstream file(name, ios::binary);
+        if(!file) {
+            record.distribution = "error";
+            record.parameters = "can't open file";
+            return;
+        }
+        //Same readers as the single file mode: binary files, then text, plain or compressed, read by the pipelined reader.
+        DataHolder data;
+        if(is_binary_input(file)) {
+            if(!read_binary(file, data)) {
+                record.distribution = "error";
+                record.parameters = "invalid binary input";
+                return;
+            }
+            analyse_data(move(data), settings, record);
+            return;
+        }
+        Compression compression = detect_compression(file);
+        if(!compression_supported(compression)) {
+            record.distribution = "error";
+            record.parameters = compression == Compression::GZIP ? "gzip isn't supported by this build" : "zstd isn't supported by this build";
+            return;
+        }
+        int fd = open(name.c_str(), O_RDONLY);
+        bool valid = fd >= 0 && read_pipelined(fd, data, true);
+        if(fd >= 0) {
+            close(fd);
+        }
+        if(!valid) {
+            record.distribution = "error";
+            record.parameters = "can't read file";
+            return;
+        }
+        analyse_data(move(data), settings, record);
+    }
+    
+    size_t write_report(const string& key, const vector<string>& names, const vector<batch_record>& records, ostream& report) {
+        size_t failures = 0;
+        report.precision(numeric_limits<input_data_t>::max_digits10);
+        report << key << "\tsamples\tdistribution\tparameters\tscore" << endl;
+        for(size_t i = 0; i < names.size(); ++i) {
+            const batch_record& record = records[i];
+            failures += record.distribution == "error";
+            report << names[i] << "\t" << record.samples << "\t" << record.distribution << "\t" << record.parameters << "\t" << record.score;
+            report << "\n";
+        }
+        report.flush();
+        return failures;
+    }
+}
+
+bool expand_batch_pattern(const string& pattern, vector<string>& files) {
+    glob_t matches;
+    int result = glob(pattern.c_str(), 0, nullptr, &matches);
+    if(result) {
+        if(result != GLOB_NOMATCH) {
+            globfree(&matches);
+        }
+        return false;
+    }
+    files.insert(files.end(), matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+    globfree(&matches);
+    return true;
+}
+
+void read_batch_list(istream& list, vector<string>& files) {
+    string line;
+    while(getline(list, line)) {
+        if(!line.empty()) {
+            files.push_back(line);
+        }
+    }
+}
+
+size_t run_batch(const vector<string>& files, const AnalyserSettings& settings, ostream& report) {
+    vector<batch_record> records(files.size());
+    //Each file is a chunk of the shared pool, so the fits inside run serially on their thread instead of oversubscribing it.
+    parallel_for(shared_task_pool(), 0, files.size(), 1, [&files, &settings, &records](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i) {
+            analyse_file(files[i], settings, records[i]);
+        }
+    });
+    return write_report("file", files, records, report);
+}
+
+size_t run_columns(istream& input, char delimiter, const vector<string>& selected, const AnalyserSettings& settings,
+                   ostream& report) {
+    vector<string> names;
+    vector<DataHolder> columns;
+    read_columns(input, delimiter, names, columns);
+    vector<string> report_names = selected.empty() ? names : selected;
+    vector<batch_record> records(report_names.size());
+    vector<size_t> indices(report_names.size(), names.size());
+    vector<size_t> uses(names.size(), 0);
+    for(size_t i = 0; i < report_names.size(); ++i) {
+        //A selected column is looked up by name first, then by its position.
+        size_t index = find(names.begin(), names.end(), report_names[i]) - names.begin();
+        if(index == names.size()) {
+            size_t next_position = 0;
+            try {
+                index = stoul(report_names[i], &next_position) - 1;
+            }
+            catch(exception& e) {
+                next_position = 0;
+            }
+            if(next_position != report_names[i].size() || index >= names.size()) {
+                records[i].distribution = "error";
+                records[i].parameters = "no such column";
+                continue;
+            }
+        }
+        indices[i] = index;
+        ++uses[index];
+    }
+    parallel_for(shared_task_pool(), 0, report_names.size(), 1, [&](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i) {
+            if(indices[i] == names.size()) {
+                continue;
+            }
+            //A column selected more than once is copied. Otherwise its samples are moved into the analyser.
+            DataHolder& column = columns[indices[i]];
+            analyse_data(uses[indices[i]] > 1 ? DataHolder(column) : move(column), settings, records[i]);
+        }
+    });
+    return write_report("column", report_names, records, report);
+}
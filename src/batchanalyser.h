@@ -0,0 +1,68 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BATCHANALYSER_H
+#define BATCHANALYSER_H
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstddef>
+#include "analyser.h"
+
+/**
+ * Appends the files matching a shell pattern, in alphabetical order.
+ * @param pattern The pattern, e.g. "station_*.txt".
+ * @param files The list that receives the matches.
+ * @return false if nothing matched.
+ */
+bool expand_batch_pattern(const std::string& pattern, std::vector<std::string>& files);
+
+/**
+ * Appends the file names listed in a stream, one per line. Empty lines are skipped.
+ * @param list The stream with the names.
+ * @param files The list that receives the names.
+ */
+void read_batch_list(std::istream& list, std::vector<std::string>& files);
+
+/**
+ * Fits every file concurrently, on the shared task pool, and writes a tab separated report with a header and one record per file, in the
+ * order of files: file name, number of samples, distribution, parameters and score. Each file is read like the input of a single
+ * fit: binary files with read_binary, and text, compressed or not, with read_pipelined. Files that can't be read, are compressed in a
+ * format this build can't read or have no data get "error" as the distribution and the reason as the parameters.
+ * @param files The files to analyse.
+ * @param settings The settings used for every file.
+ * @param report The stream that receives the report.
+ * @return The number of files that failed.
+ */
+std::size_t run_batch(const std::vector<std::string>& files, const AnalyserSettings& settings, std::ostream& report);
+
+/**
+ * Reads a delimited table in one pass and fits its columns concurrently, on the shared task pool. Writes a report in the format of run_batch,
+ * with one record per column.
+ * @param input The table. See read_columns.
+ * @param delimiter The field delimiter, or 0 to detect it.
+ * @param selected The columns to fit, by name or by position starting at 1. If empty, every column.
+ * @param settings The settings used for every column.
+ * @param report The stream that receives the report.
+ * @return The number of columns that failed.
+ */
+std::size_t run_columns(std::istream& input, char delimiter, const std::vector<std::string>& selected, const AnalyserSettings& settings,
+                        std::ostream& report);
+
+#endif // BATCHANALYSER_H
@@ -23,20 +23,13 @@
 
 using namespace std;
 
-//These variables are made global to this file to preserve state (not sure if necessary).
-//Also they're implemented in an unamed namespace so they can't be accessed from outside.
-namespace {
-    random_device rd;
-    mt19937 mt(rd());
-    uniform_real_distribution<input_data_t> dist(0, std::nextafter(static_cast<input_data_t>(1.0), static_cast<input_data_t>(2.0)));
-}
-
-input_data_t DataHistogram::generate_value() const {
+input_data_t DataHistogram::generate_value(RandomEngine& engine) const {
     if(_organized_data.empty()) {
         return numeric_limits<input_data_t>::quiet_NaN();
     }
     size_t low = 0, high = _organized_data.size();
-    input_data_t random_value = dist(mt);
+    uniform_real_distribution<input_data_t> dist(0, std::nextafter(static_cast<input_data_t>(1.0), static_cast<input_data_t>(2.0)));
+    input_data_t random_value = dist(engine);
     //Finds the first class with probability less than random value.
     //Since the value is uniform in the interval (0,1), it works like a voting system, where the more data one class has, the more likely
     //it is to be chosen.
@@ -53,12 +46,103 @@ input_data_t DataHistogram::generate_value() const {
 }
 
 
+DataHistogram DataHistogram::with_edges(input_data_t lower, input_data_t upper, size_t classes) {
+    return with_counts(lower, (upper - lower) / classes, vector<size_t>(classes, 0));
+}
+
+DataHistogram DataHistogram::with_counts(input_data_t lower, input_data_t class_width, const vector<size_t>& counts) {
+    DataHistogram histogram;
+    histogram._lower = lower;
+    histogram._class_width = class_width;
+    histogram._organized_data.reserve(counts.size());
+    //Every bound is computed from its index, so histograms on the same grid get exactly the same edges.
+    for(size_t i = 0; i < counts.size(); ++i) {
+        input_data_t lower_bound = lower + i * class_width;
+        input_data_t upper_bound = lower + (i + 1) * class_width;
+        monte_carlo_class new_class = {lower_bound + class_width / 2, 0, counts[i], lower_bound, upper_bound};
+        histogram._organized_data.push_back(new_class);
+        histogram._data_count += counts[i];
+    }
+    histogram._update_probabilities();
+    return histogram;
+}
+
+bool DataHistogram::merge(const DataHistogram& other) {
+    if(other._organized_data.empty()) {
+        return other.is_mergeable() || !other._data_count;
+    }
+    if(_organized_data.empty() && !_class_width) {
+        *this = other;
+        return other.is_mergeable();
+    }
+    if(!is_mergeable() || _class_width != other._class_width) {
+        return false;
+    }
+    input_data_t offset = (other._lower - _lower) / _class_width;
+    input_data_t shift = round(offset);
+    if(abs(offset - shift) > 1e-6) {
+        return false;
+    }
+    long long first = std::min(0LL, static_cast<long long>(shift));
+    long long last = std::max(static_cast<long long>(_organized_data.size()), static_cast<long long>(shift) + static_cast<long long>(other._organized_data.size()));
+    vector<size_t> counts(last - first, 0);
+    for(size_t i = 0; i < _organized_data.size(); ++i) {
+        counts[i - first] += _organized_data[i].class_count;
+    }
+    for(size_t i = 0; i < other._organized_data.size(); ++i) {
+        counts[static_cast<long long>(shift) + i - first] += other._organized_data[i].class_count;
+    }
+    input_data_t lower = first ? other._lower : _lower;
+    *this = with_counts(lower, _class_width, counts);
+    return true;
+}
+
+DataHistogram DataHistogram::coarsened(size_t classes) const {
+    size_t fine = _organized_data.size();
+    if(!classes || classes >= fine) {
+        return *this;
+    }
+    DataHistogram histogram;
+    histogram._data_count = _data_count;
+    //Merging a whole number of fixed width classes keeps the grid, so the result can still be merged with others.
+    if(is_mergeable() && fine % classes == 0) {
+        histogram._lower = _lower;
+        histogram._class_width = _class_width * (fine / classes);
+    }
+    histogram._organized_data.reserve(classes);
+    for(size_t i = 0; i < classes; ++i) {
+        //Class i takes the fine classes from i * fine / classes, so their numbers differ by at most one.
+        size_t first = i * fine / classes;
+        size_t last = (i + 1) * fine / classes;
+        input_data_t lower_bound = _organized_data[first].lower_bound;
+        input_data_t upper_bound = _organized_data[last - 1].upper_bound;
+        size_t count = 0;
+        for(size_t j = first; j < last; ++j) {
+            count += _organized_data[j].class_count;
+        }
+        monte_carlo_class new_class = {lower_bound + (upper_bound - lower_bound) / 2, 0, count, lower_bound, upper_bound};
+        histogram._organized_data.push_back(new_class);
+    }
+    histogram._update_probabilities();
+    return histogram;
+}
+
+void DataHistogram::_update_probabilities() {
+    input_data_t acum = 0;
+    for(monte_carlo_class& klass : _organized_data) {
+        klass.acum_probability = acum;
+        if(_data_count) {
+            acum += klass.class_count * static_cast<input_data_t>(1.0) / _data_count;
+        }
+    }
+}
+
 input_data_t DataHistogram::histogram_mean() const {
     if(_organized_data.empty()) {
         return numeric_limits<input_data_t>::quiet_NaN();
     }
     input_data_t sum = 0;
-    for(int i = 0; i < _organized_data.size(); ++i) {
+    for(size_t i = 0; i < _organized_data.size(); ++i) {
         auto& el = _organized_data[i];
         sum += el.class_count * (el.value / (input_data_t)_data_count);
     }
@@ -74,7 +158,7 @@ input_data_t DataHistogram::histogram_variance() const {
     }
     input_data_t mean = histogram_mean();
     input_data_t sum = 0;
-    for(int i = 0; i < _organized_data.size(); ++i) {
+    for(size_t i = 0; i < _organized_data.size(); ++i) {
         auto& el = _organized_data[i];
         input_data_t dif_from_mean = el.value - mean;
         sum += el.class_count * ((dif_from_mean * dif_from_mean) / max(static_cast<input_data_t>(1.0), (input_data_t)(_data_count - 1)));
@@ -117,6 +201,32 @@ input_data_t DataHistogram::histogram_mode() const {
     return return_value;
 }
 
+void DataHistogram::save(ostream& os) const {
+    auto precision = os.precision(numeric_limits<input_data_t>::max_digits10);
+    os << _data_count << " " << _lower << " " << _class_width << " " << _organized_data.size() << endl;
+    for(const monte_carlo_class& klass : _organized_data) {
+        os << klass.value << " " << klass.acum_probability << " " << klass.class_count << " " << klass.lower_bound << " ";
+        os << klass.upper_bound << endl;
+    }
+    os.precision(precision);
+}
+
+bool DataHistogram::load(istream& is) {
+    DataHistogram read;
+    size_t classes = 0;
+    is >> read._data_count >> read._lower >> read._class_width >> classes;
+    for(size_t i = 0; is && i < classes; ++i) {
+        monte_carlo_class klass;
+        is >> klass.value >> klass.acum_probability >> klass.class_count >> klass.lower_bound >> klass.upper_bound;
+        read._organized_data.push_back(klass);
+    }
+    if(!is) {
+        return false;
+    }
+    *this = move(read);
+    return true;
+}
+
 DataHistogram::monte_carlo_class_printer DataHistogram::print_classes() {
     DataHistogram::monte_carlo_class_printer printer;
     printer.classes = &(this->_organized_data);
@@ -127,7 +237,7 @@ ostream& operator<<(ostream& os, const DataHistogram::monte_carlo_class_printer&
     if(printer.classes->empty()) {
         return os;
     }
-    int i = 0;
+    size_t i = 0;
     for(; i < printer.classes->size() - 1; ++i) {
         os << (*printer.classes)[i] << endl;    
     }
@@ -22,7 +22,9 @@
 #include <algorithm>
 #include <iostream>
 #include "inputtypes.h"
+#include "randomengine.h"
 #include <cmath>
+#include <limits>
 
 /**
  * Class representing a histogram for statistical purposes.
@@ -31,6 +33,11 @@ class DataHistogram {
 public:
     //Constructors
     
+    /**
+     * Constructs an empty histogram, with no classes and no data.
+     */
+    DataHistogram(): _organized_data(), _data_count(0), _lower(0), _class_width(0) {}
+    
     /**
      * Constructor for histogram.
      * @param begin iterator to first element of data.
@@ -42,11 +49,109 @@ public:
     template<typename Iterator>
     DataHistogram(Iterator begin, Iterator end, std::size_t classes = 0);
     
+    /**
+     * Constructor for the histogram of weighted data. It is the histogram of the data with each value repeated its count times.
+     * @param begin iterator to first element of data.
+     * @param end iterator to element one past the end of data.
+     * @param counts iterator to the count of the first element.
+     * @param classes desired number of classes, 0 to pick it from the sample size.
+     * @pre <strong class="paramname">begin</strong> < <strong class="paramname">end</strong>.
+     */
+    template<typename Iterator, typename CountIterator>
+    DataHistogram(Iterator begin, Iterator end, CountIterator counts, std::size_t classes);
+    
+    //Fixed edge histograms. Their edges don't depend on the data, so histograms built on different parts of a data set can be merged.
+    
+    /**
+     * Creates an empty histogram with classes of the same width covering [lower, upper). Values outside the range are counted in
+     * the first or the last class.
+     * @param lower The lower bound of the first class.
+     * @param upper The upper bound of the last class.
+     * @param classes The number of classes.
+     * @pre <strong class="paramname">lower</strong> < <strong class="paramname">upper</strong>.
+     * @pre <strong class="paramname">classes</strong> > 0.
+     * @return The histogram.
+     */
+    static DataHistogram with_edges(input_data_t lower, input_data_t upper, std::size_t classes);
+    
+    /**
+     * Creates a histogram with classes of the same width and the supplied counts.
+     * @param lower The lower bound of the first class.
+     * @param class_width The width of each class.
+     * @param counts The number of elements of each class.
+     * @pre <strong class="paramname">class_width</strong> > 0.
+     * @return The histogram.
+     */
+    static DataHistogram with_counts(input_data_t lower, input_data_t class_width, const std::vector<std::size_t>& counts);
+    
+    /**
+     * Creates a histogram whose edges are the multiples of class_width that cover the data. Histograms built with the same width
+     * are aligned to the same grid, so any two of them can be merged.
+     * @param begin iterator to first element of data.
+     * @param end iterator to element one past the end of data.
+     * @param class_width The width of each class.
+     * @pre <strong class="paramname">begin</strong> < <strong class="paramname">end</strong>.
+     * @pre <strong class="paramname">class_width</strong> > 0.
+     * @return The histogram.
+     */
+    template<typename Iterator>
+    static DataHistogram on_grid(Iterator begin, Iterator end, input_data_t class_width);
+    
+    /**
+     * Adds data to a fixed edge histogram.
+     * @param begin iterator to first element of data.
+     * @param end iterator to element one past the end of data.
+     * @pre is_mergeable().
+     */
+    template<typename Iterator>
+    void insert(Iterator begin, Iterator end);
+    
+    /**
+     * Adds the counts of other to this histogram. Both must be fixed edge histograms with the same class width and edges on the
+     * same grid. The result covers both ranges.
+     * @param other The histogram to merge.
+     * @return false, leaving this histogram untouched, if the edges don't match.
+     */
+    bool merge(const DataHistogram& other);
+    
+    /**
+     * Derives a coarser histogram by merging runs of adjacent classes, as evenly as possible, without the samples. A fine histogram
+     * built once can then stand for every coarser resolution.
+     * @param classes The number of classes of the result.
+     * @return The merged histogram, or a copy of this one if it doesn't have more than classes classes.
+     */
+    DataHistogram coarsened(std::size_t classes) const;
+    
+    /**
+     * Tells if the histogram has fixed edges.
+     * @return true if the histogram can be merged and receive more data.
+     */
+    bool is_mergeable() const {
+        return _class_width > 0;
+    }
+    
+    /**
+     * Gets the width of the classes of a fixed edge histogram.
+     * @return The class width, or 0 if the edges depend on the data.
+     */
+    input_data_t class_width() const {
+        return _class_width;
+    }
+    
+    /**
+     * Function that uses the histogram as a random number generator, with the engine of the calling thread.
+     * @return A random number based on the frequency distribution of the supplied data.
+     */
+    input_data_t generate_value() const {
+        return generate_value(thread_random_engine());
+    }
+    
     /**
      * Function that uses the histogram as a random number generator.
+     * @param engine The random engine to draw from.
      * @return A random number based on the frequency distribution of the supplied data.
      */
-    input_data_t generate_value() const;
+    input_data_t generate_value(RandomEngine& engine) const;
     
     /**
      * Function that calculates the mean of the histogram.
@@ -84,6 +189,20 @@ public:
      */
     input_data_t histogram_mode() const;
     
+    /**
+     * Writes the histogram, classes and all, in a format read back by load. Values are written with enough digits to be read back
+     * exactly.
+     * @param os The output stream.
+     */
+    void save(std::ostream& os) const;
+    
+    /**
+     * Reads a histogram written by save. On a malformed input, sets the failbit of the stream and leaves the histogram untouched.
+     * @param is The input stream.
+     * @return true if the histogram was read.
+     */
+    bool load(std::istream& is);
+    
     /**
     * Internal struct that contains data for each histogram class
     */
@@ -181,6 +300,20 @@ private:
     std::vector<monte_carlo_class> _organized_data;
     
     std::size_t _data_count;
+    
+    input_data_t _lower;
+    
+    input_data_t _class_width;
+    
+    void _update_probabilities();
+    
+    /**
+     * Builds the classes of the constructors that take data.
+     * @param counts The counts of the data. It is only used if weighted.
+     * @param weighted false to count each value once.
+     */
+    template<typename Iterator, typename CountIterator>
+    void _build(Iterator begin, Iterator end, CountIterator counts, bool weighted, std::size_t classes);
 public:
     
     /**
@@ -210,7 +343,27 @@ public:
 
 //Since it is a templated method, we implement it in the header.
 template<typename Iterator>
-DataHistogram::DataHistogram(Iterator begin, Iterator end, std::size_t classes): _data_count(std::distance(begin, end)) {
+DataHistogram::DataHistogram(Iterator begin, Iterator end, std::size_t classes): DataHistogram() {
+    _build(begin, end, static_cast<const std::size_t*>(nullptr), false, classes);
+}
+
+template<typename Iterator, typename CountIterator>
+DataHistogram::DataHistogram(Iterator begin, Iterator end, CountIterator counts, std::size_t classes): DataHistogram() {
+    _build(begin, end, counts, true, classes);
+}
+
+template<typename Iterator, typename CountIterator>
+void DataHistogram::_build(Iterator begin, Iterator end, CountIterator counts, bool weighted, std::size_t classes) {
+    _data_count = 0;
+    if(weighted) {
+        CountIterator count = counts;
+        for(Iterator it = begin; it != end; ++it) {
+            _data_count += *count++;
+        }
+    }
+    else {
+        _data_count = std::distance(begin, end);
+    }
     //If the difference between the max element and the minimum element is lesser than this value, we don't split the data into classes.
     input_data_t EPSLON = 0;
     input_data_t sqrt_sz = std::sqrt(_data_count);
@@ -223,7 +376,7 @@ DataHistogram::DataHistogram(Iterator begin, Iterator end, std::size_t classes):
     auto min_max = std::minmax_element(begin, end);
     input_data_t min = *min_max.first, max = *min_max.second;
     //We split the input data into classes. For now, it just gets the minimum between the amount of data / 10 + 1 and 15.
-    int number_of_classes = classes;
+    std::size_t number_of_classes = classes;
     if(!number_of_classes || number_of_classes > _data_count) {
         number_of_classes = max - min < EPSLON ? 1 : sqrt_sz;
     }
@@ -236,7 +389,7 @@ DataHistogram::DataHistogram(Iterator begin, Iterator end, std::size_t classes):
     input_data_t lower_bound = step ? min - step / 2 : min;
     input_data_t upper_bound = step ? min + step / 2 : max;
     //Insert all the classes into a vector.
-    for(int i = 0; i < number_of_classes; ++i) {
+    for(std::size_t i = 0; i < number_of_classes; ++i) {
         input_data_t avg = lower_bound + (upper_bound - lower_bound) / 2;
         monte_carlo_class new_class = {avg, 0, 0, lower_bound, upper_bound};
         lower_bound += step;
@@ -258,7 +411,7 @@ DataHistogram::DataHistogram(Iterator begin, Iterator end, std::size_t classes):
                 low = mid + 1;
             }
         }
-        ++_organized_data[--low].class_count;
+        _organized_data[--low].class_count += weighted ? *counts++ : 1;
     }
     input_data_t acum = 0;
     for(monte_carlo_class& klass : _organized_data) {
@@ -267,4 +420,27 @@ DataHistogram::DataHistogram(Iterator begin, Iterator end, std::size_t classes):
     }
 }
 
+template<typename Iterator>
+DataHistogram DataHistogram::on_grid(Iterator begin, Iterator end, input_data_t class_width) {
+    auto min_max = std::minmax_element(begin, end);
+    input_data_t first = std::floor(*min_max.first / class_width);
+    input_data_t last = std::floor(*min_max.second / class_width);
+    DataHistogram histogram = with_counts(first * class_width, class_width, std::vector<std::size_t>(last - first + 1, 0));
+    histogram.insert(begin, end);
+    return histogram;
+}
+
+template<typename Iterator>
+void DataHistogram::insert(Iterator begin, Iterator end) {
+    std::size_t last = _organized_data.size() - 1;
+    //The edges are evenly spaced, so the class is found with a division instead of a search.
+    for(; begin != end; ++begin) {
+        input_data_t position = std::floor((*begin - _lower) / _class_width);
+        std::size_t index = position > 0 ? std::min(static_cast<std::size_t>(position), last) : 0;
+        ++_organized_data[index].class_count;
+        ++_data_count;
+    }
+    _update_probabilities();
+}
+
 #endif // DATAHISTOGRAM_H
@@ -17,114 +17,340 @@
  */
 
 #include "dataholder.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <cmath>
 
 using namespace std;
 
-ostream& operator<<(ostream& os, const DataHolder& dh) {
+namespace {
+    //Splits a line on the delimiter, dropping the spaces and quotes around each field.
+    void split_fields(const string& line, char delimiter, vector<string>& fields) {
+        fields.clear();
+        size_t start = 0;
+        while(true) {
+            size_t end = line.find(delimiter, start);
+            size_t last = end == string::npos ? line.size() : end;
+            size_t first = line.find_first_not_of(" \t\r\"", start);
+            first = std::min(first, last);
+            while(last > first && (line[last - 1] == ' ' || line[last - 1] == '\t' || line[last - 1] == '\r' || line[last - 1] == '"')) {
+                --last;
+            }
+            fields.push_back(line.substr(first, last - first));
+            if(end == string::npos) {
+                return;
+            }
+            start = end + 1;
+        }
+    }
+}
+
+template<typename T>
+ostream& operator<<(ostream& os, const BasicDataHolder<T>& dh) {
     for(float value: dh._data) {
         os << value << " ";
     }
     return os;
 }
     
-istream& operator>>(istream& is, DataHolder& dh) {
-    input_data_t value = 0;
-    
-    std::string parsed;
+bool parse_input_value(const string& token, input_data_t& value) {
     size_t next_position;
-    is >> parsed;
     try {
-        value = stod(parsed, &next_position);
-        if(next_position != parsed.size()) {
-            is.setstate(ios::failbit);
-            return is;
-        }
-        std::size_t n = dh._data.size();
-        input_data_t new_size = static_cast<input_data_t>(n + 1);
-        dh._current_mean = dh._current_mean * (n / new_size) + value / new_size;
-        dh._current_max = std::max(dh._current_max, value);
-        dh._current_min = std::min(dh._current_min, value);
-        dh._data.push_back(value);
-        dh._compute_variance_and_standard_deviation();
-    }
-            
+        value = stod(token, &next_position);
+    }
     catch(exception& e) {
+        return false;
+    }
+    return next_position == token.size();
+}
+
+template<typename T>
+istream& operator>>(istream& is, BasicDataHolder<T>& dh) {
+    input_data_t value = 0;
+    std::string parsed;
+    is >> parsed;
+    if(!parse_input_value(parsed, value)) {
         is.setstate(ios::failbit);
         return is;
     }
+    T stored = static_cast<T>(value);
+    dh._data.push_back(stored);
+    dh._moments.add(stored);
+    if(!dh._counts.empty()) {
+        dh._counts.push_back(1);
+    }
     return is;
 }
 
-typename DataHolder::iterator DataHolder::begin() {
+template<typename T>
+typename BasicDataHolder<T>::iterator BasicDataHolder<T>::begin() {
     return _data.begin();
 }
     
-typename DataHolder::iterator DataHolder::end() {
+template<typename T>
+typename BasicDataHolder<T>::iterator BasicDataHolder<T>::end() {
     return _data.end();
 }
 
-typename DataHolder::const_iterator DataHolder::begin() const {
+template<typename T>
+typename BasicDataHolder<T>::const_iterator BasicDataHolder<T>::begin() const {
     return _data.begin();
 }
 
-typename DataHolder::const_iterator DataHolder::end() const {
+template<typename T>
+typename BasicDataHolder<T>::const_iterator BasicDataHolder<T>::end() const {
     return _data.end();
 }
 
-DataHolder& operator<<(DataHolder& ob, input_data_t dat) {
-    std::size_t n = ob._data.size();
-    input_data_t new_size = static_cast<input_data_t>(n + 1);
-    ob._current_mean = ob._current_mean * (n / new_size) + dat / new_size;
-    ob._data.push_back(dat);
-    ob._current_max = std::max(ob._current_max, dat);
-    ob._current_min = std::min(ob._current_min, dat);
-    ob._compute_variance_and_standard_deviation();
+template<typename T>
+BasicDataHolder<T>& operator<<(BasicDataHolder<T>& ob, input_data_t dat) {
+    //The moments get the stored value, so they agree exactly with the samples.
+    T stored = static_cast<T>(dat);
+    ob._data.push_back(stored);
+    ob._moments.add(stored);
+    if(!ob._counts.empty()) {
+        ob._counts.push_back(1);
+    }
     return ob;
 }
 
-input_data_t DataHolder::mean() const {
-    return _current_mean;
+template<typename T>
+input_data_t BasicDataHolder<T>::mean() const {
+    return _moments.mean();
 }
     
     
-input_data_t DataHolder::variance() const {
-    return _current_var;
+template<typename T>
+input_data_t BasicDataHolder<T>::variance() const {
+    return _moments.variance();
 }
     
     
-input_data_t DataHolder::standard_deviation() const {
-    return _current_standard_deviation;
+template<typename T>
+input_data_t BasicDataHolder<T>::standard_deviation() const {
+    return _moments.standard_deviation();
 }
 
     
-input_data_t DataHolder::max() const {
-    return _current_max;
+template<typename T>
+input_data_t BasicDataHolder<T>::max() const {
+    return _moments.max();
 }
     
     
-input_data_t DataHolder::min() const {
-    return _current_min;
+template<typename T>
+input_data_t BasicDataHolder<T>::min() const {
+    return _moments.min();
 }
     
     
-DataHistogram DataHolder::generate_histogram(std::size_t number_classes) const {
+template<typename T>
+DataHistogram BasicDataHolder<T>::generate_histogram(std::size_t number_classes) const {
+    if(!_counts.empty()) {
+        return DataHistogram(_data.begin(), _data.end(), _counts.begin(), number_classes);
+    }
     return DataHistogram(_data.begin(), _data.end(), number_classes);
 }
 
-void DataHolder::_compute_variance_and_standard_deviation() {
-    if(!_data.size()) {
-        _current_standard_deviation = std::numeric_limits<input_data_t>::quiet_NaN();
-        _current_var = std::numeric_limits<input_data_t>::quiet_NaN();
+template<typename T>
+void BasicDataHolder<T>::add(input_data_t value, size_t count) {
+    //The samples added so far, if any, were seen once each.
+    if(_counts.empty()) {
+        _counts.assign(_data.size(), 1);
+    }
+    T stored = static_cast<T>(value);
+    _data.push_back(stored);
+    _counts.push_back(count);
+    _moments.add(stored, static_cast<input_data_t>(count));
+}
+
+size_t estimate_sample_count(istream& is) {
+    streampos start = is.tellg();
+    if(start == streampos(-1) || !is.seekg(0, ios::end)) {
+        is.clear();
+        return 0;
+    }
+    streamoff remaining = is.tellg() - start;
+    is.seekg(start);
+    //The first block is taken as representative of the whole file.
+    vector<char> block(static_cast<size_t>(std::min(remaining, static_cast<streamoff>(1 << 16))));
+    is.read(block.data(), block.size());
+    size_t read = is.gcount();
+    is.clear();
+    is.seekg(start);
+    size_t tokens = 0;
+    bool in_token = false;
+    for(size_t i = 0; i < read; ++i) {
+        bool space = isspace(static_cast<unsigned char>(block[i]));
+        tokens += !space && !in_token;
+        in_token = !space;
+    }
+    if(!read || !tokens) {
+        return 0;
+    }
+    //A little slack, so a file whose numbers get slightly shorter after the first block doesn't reallocate at the very end.
+    return static_cast<size_t>(static_cast<double>(remaining) * tokens / read * 1.05) + 1;
+}
+
+namespace {
+    const char binary_magic[4] = {'I', 'A', 'B', '1'};
+    
+    struct binary_header {
+        char magic[4];
+        
+        uint32_t sample_size;
+        
+        uint64_t reserved;
+        
+        uint64_t count;
+    };
+    
+    template<typename T, typename S>
+    bool read_binary_samples(istream& is, uint64_t count, BasicDataHolder<T>& holder) {
+        const size_t block_size = 1 << 16;
+        vector<S> block(static_cast<size_t>(std::min<uint64_t>(count, block_size)));
+        while(count) {
+            size_t size = static_cast<size_t>(std::min<uint64_t>(count, block_size));
+            if(!is.read(reinterpret_cast<char*>(block.data()), size * sizeof(S))) {
+                return false;
+            }
+            holder.append(block.begin(), block.begin() + size);
+            count -= size;
+        }
+        return true;
+    }
+}
+
+bool is_binary_input(istream& is) {
+    char magic[sizeof(binary_magic)] = {};
+    streambuf* buffer = is.rdbuf();
+    //Only the first character is surely available to peek on every stream, so a mismatch there avoids touching the rest.
+    if(!buffer || buffer->sgetc() != binary_magic[0]) {
+        return false;
+    }
+    streampos start = is.tellg();
+    if(start == streampos(-1)) {
+        is.clear();
+        return false;
+    }
+    is.read(magic, sizeof(magic));
+    is.clear();
+    is.seekg(start);
+    return !memcmp(magic, binary_magic, sizeof(magic));
+}
+
+template<typename T>
+bool read_binary(istream& is, BasicDataHolder<T>& holder) {
+    binary_header header;
+    if(!is.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, binary_magic, sizeof(binary_magic))) {
+        return false;
+    }
+    if(header.sample_size != sizeof(float) && header.sample_size != sizeof(double)) {
+        return false;
+    }
+    //The count comes from the file, so the reservation is limited to the samples the rest of the stream can hold. A corrupt
+    //header then fails while reading instead of allocating. Streams that can't seek grow the storage as they are read.
+    uint64_t available = 0;
+    streampos start = is.tellg();
+    if(start != streampos(-1) && is.seekg(0, ios::end)) {
+        available = static_cast<uint64_t>(is.tellg() - start) / header.sample_size;
+        is.seekg(start);
+    }
+    is.clear();
+    holder.reserve(holder.data_size() + static_cast<size_t>(std::min(header.count, available)));
+    if(header.sample_size == sizeof(float)) {
+        return read_binary_samples<T, float>(is, header.count, holder);
+    }
+    return read_binary_samples<T, double>(is, header.count, holder);
+}
+
+template<typename T>
+bool write_binary(ostream& os, const BasicDataHolder<T>& holder) {
+    binary_header header;
+    memcpy(header.magic, binary_magic, sizeof(binary_magic));
+    header.sample_size = sizeof(T);
+    header.reserved = 0;
+    header.count = holder.data_size();
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(holder.data()), holder.data_size() * sizeof(T));
+    return static_cast<bool>(os);
+}
+
+template bool read_binary(istream& is, BasicDataHolder<input_data_t>& holder);
+template bool read_binary(istream& is, BasicDataHolder<single_data_t>& holder);
+template bool write_binary(ostream& os, const BasicDataHolder<input_data_t>& holder);
+template bool write_binary(ostream& os, const BasicDataHolder<single_data_t>& holder);
+
+template class BasicDataHolder<input_data_t>;
+template class BasicDataHolder<single_data_t>;
+template ostream& operator<<(ostream& os, const BasicDataHolder<input_data_t>& dh);
+template ostream& operator<<(ostream& os, const BasicDataHolder<single_data_t>& dh);
+template istream& operator>>(istream& is, BasicDataHolder<input_data_t>& dh);
+template istream& operator>>(istream& is, BasicDataHolder<single_data_t>& dh);
+template BasicDataHolder<input_data_t>& operator<<(BasicDataHolder<input_data_t>& ob, input_data_t dat);
+template BasicDataHolder<single_data_t>& operator<<(BasicDataHolder<single_data_t>& ob, input_data_t dat);
+
+void read_columns(istream& is, char delimiter, vector<string>& names, vector<DataHolder>& columns) {
+    names.clear();
+    columns.clear();
+    string line;
+    if(!getline(is, line)) {
         return;
     }
-    _current_var = 0;
-    if(_data.size() > 1) {
-        for(auto dat: _data) {
-            _current_var -= 2 / static_cast<input_data_t>(_data.size() - 1) * _current_mean * dat;
-            _current_var += (dat / static_cast<input_data_t>(_data.size() - 1) * dat);
-            _current_var += _current_mean / static_cast<input_data_t>(_data.size() - 1) * _current_mean;
+    if(!delimiter) {
+        delimiter = line.find('\t') != string::npos ? '\t' : line.find(',') != string::npos ? ',' : ';';
+    }
+    vector<string> fields;
+    split_fields(line, delimiter, fields);
+    input_data_t value = 0;
+    bool header = false;
+    for(const string& field : fields) {
+        header = header || (!field.empty() && !parse_input_value(field, value));
+    }
+    columns.resize(fields.size());
+    for(size_t i = 0; i < fields.size(); ++i) {
+        names.push_back(header ? fields[i] : to_string(i + 1));
+    }
+    do {
+        if(header) {
+            header = false;
+            continue;
+        }
+        split_fields(line, delimiter, fields);
+        for(size_t i = 0; i < fields.size() && i < columns.size(); ++i) {
+            if(parse_input_value(fields[i], value)) {
+                columns[i] << value;
+            }
         }
-        _current_standard_deviation = std::sqrt(_current_var);
+    } while(getline(is, line));
+}
+
+template<typename T>
+void read_weighted(istream& is, BasicDataHolder<T>& holder) {
+    string line;
+    input_data_t value = 0, count = 0;
+    const input_data_t max_count = static_cast<input_data_t>(1ULL << 53);
+    while(getline(is, line)) {
+        size_t first = line.find_first_not_of(" \t\r,");
+        size_t first_end = line.find_first_of(" \t\r,", first);
+        if(first == string::npos || !parse_input_value(line.substr(first, first_end - first), value)) {
+            continue;
+        }
+        size_t second = first_end == string::npos ? string::npos : line.find_first_not_of(" \t\r,", first_end);
+        if(second == string::npos) {
+            holder.add(value, 1);
+            continue;
+        }
+        size_t second_end = line.find_first_of(" \t\r,", second);
+        if(!parse_input_value(line.substr(second, second_end - second), count) || !(count >= 1 && count < max_count) ||
+           count != floor(count)) {
+            continue;
+        }
+        holder.add(value, static_cast<size_t>(count));
     }
-    
 }
+
+template void read_weighted(istream& is, BasicDataHolder<input_data_t>& holder);
+template void read_weighted(istream& is, BasicDataHolder<single_data_t>& holder);
@@ -21,43 +21,56 @@
 
 #include <vector>
 #include <iostream>
+#include <string>
+#include <limits>
 #include "inputtypes.h"
 #include "datahistogram.h"
+#include "samplemoments.h"
+#include "hugepageallocator.h"
+
+template<typename T>
+class BasicDataHolder;
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const BasicDataHolder<T>& obj);
+
+template<typename T>
+BasicDataHolder<T>& operator<<(BasicDataHolder<T>& ob, input_data_t data);
+
+template<typename T>
+std::istream& operator>>(std::istream& is, BasicDataHolder<T>& obj);
 
 /**
  * Class that we use to grab data from istream. It can also be used to output data to an ostream.
+ * The samples are stored as T, float or double. The statistics are always computed in input_data_t, so single precision storage
+ * halves the memory and the memory traffic of the passes over the samples without losing precision in the results.
  */
-class DataHolder {
+template<typename T>
+class BasicDataHolder {
 public:
     //Typedefs
     
     /**
      * Typedef to iterator
      */
-    typedef std::vector<input_data_t>::iterator iterator;
+    typedef typename std::vector<T, HugePageAllocator<T>>::iterator iterator;
     
     /**
      * Typedef to const_iterator
      */
-    typedef std::vector<input_data_t>::const_iterator const_iterator;
+    typedef typename std::vector<T, HugePageAllocator<T>>::const_iterator const_iterator;
     
     /**
      * Typedef to value_type
      */
-    typedef std::vector<input_data_t>::value_type value_type;
+    typedef typename std::vector<T, HugePageAllocator<T>>::value_type value_type;
     
     //Constructors
     
     /**
      * Construct an object with no data.
      */
-    DataHolder(): _data() {
-        _current_mean = 0;
-        _current_var = std::numeric_limits<input_data_t>::quiet_NaN();
-        _current_min = std::numeric_limits<input_data_t>::max();
-        _current_max = -std::numeric_limits<input_data_t>::max();
-        _current_standard_deviation = std::numeric_limits<input_data_t>::quiet_NaN();
-    }
+    BasicDataHolder(): _data(), _moments() {}
     
     
     /**
@@ -67,23 +80,23 @@ public:
      * @pre <strong class="paramname">begin</strong> <= <strong class="paramname">end</strong>.
      */
     template<typename Iterator>
-    DataHolder(Iterator begin, Iterator end);
+    BasicDataHolder(Iterator begin, Iterator end);
     
     /**
      * Copy construct an object
      * @param rhs other object
      */
-    DataHolder(const DataHolder& rhs) = default;
+    BasicDataHolder(const BasicDataHolder& rhs) = default;
     
     /**
      * Move construct an object
      * @param rhs other object
      */
-    DataHolder(DataHolder&& rhs) = default;
+    BasicDataHolder(BasicDataHolder&& rhs) = default;
     
     //Destructor
     
-    ~DataHolder() = default;
+    ~BasicDataHolder() = default;
     
     //Assignment operators
     
@@ -91,13 +104,13 @@ public:
      * Copy assigns an object
      * @param rhs other object
      */
-    DataHolder& operator=(const DataHolder& rhs) = default;
+    BasicDataHolder& operator=(const BasicDataHolder& rhs) = default;
     
     /**
      * Move assigns an object
      * @param rhs other object
      */
-    DataHolder& operator=(DataHolder&& rhs) = default;
+    BasicDataHolder& operator=(BasicDataHolder&& rhs) = default;
     
     //Stream operators
     
@@ -107,7 +120,7 @@ public:
      * @param obj DataHolder to output.
      * @return The output stream <strong class="paramname">os</strong>
      */
-    friend std::ostream& operator<<(std::ostream& os, const DataHolder& obj);
+    friend std::ostream& operator<< <>(std::ostream& os, const BasicDataHolder& obj);
     
     /**
      * Inputs more data to this class.
@@ -115,7 +128,7 @@ public:
      * @param data The new deta to input.
      * This method modifies obj such that it will compute its statistical properties again.
      */
-    friend DataHolder& operator<<(DataHolder& ob, input_data_t data);
+    friend BasicDataHolder& operator<< <>(BasicDataHolder& ob, input_data_t data);
     
     /**
      * Inputs data from stream.
@@ -123,7 +136,7 @@ public:
      * @param obj DataHolder object that will read value from stream.
      * @return The input stream <strong class="paramname">is</strong>
      */
-    friend std::istream& operator>>(std::istream& is, DataHolder& obj);
+    friend std::istream& operator>> <>(std::istream& is, BasicDataHolder& obj);
     
     //Iterators
     
@@ -190,55 +203,183 @@ public:
     
     /**
      * Returns the amount of supplied data.
-     * @return The sample size.
+     * @return The number of stored values. For a weighted holder, it is the number of distinct values and not the sample size.
      */
     std::size_t data_size() const {
         return _data.size();
     }
     
-private:
     /**
-     * Computes the variance and the standard deviation for this data.
+     * Returns the number of samples the data stands for.
+     * @return The sum of the counts of a weighted holder, data_size() otherwise.
+     */
+    std::size_t sample_count() const {
+        return _counts.empty() ? _data.size() : static_cast<std::size_t>(_moments.total_weight());
+    }
+    
+    /**
+     * Adds a value seen many times, as in pre-aggregated data. The holder becomes weighted: it keeps one entry per value with its
+     * count, so memory and the passes over the data scale with the distinct values instead of the samples. Every statistic,
+     * histogram and estimate of a weighted holder is the one of the expanded samples.
+     * @param value The value.
+     * @param count The number of times it was seen.
+     * @pre <strong class="paramname">count</strong> > 0.
+     */
+    void add(input_data_t value, std::size_t count);
+    
+    /**
+     * Tells if the holder has counts, added with add.
+     * @return true if the holder is weighted.
+     */
+    bool is_weighted() const {
+        return !_counts.empty();
+    }
+    
+    /**
+     * Gives direct access to the counts of a weighted holder, parallel to data().
+     * @return Pointer to the count of the first value, or null if the holder isn't weighted.
      */
-    void _compute_variance_and_standard_deviation();
+    const std::size_t* counts() const {
+        return _counts.empty() ? nullptr : _counts.data();
+    }
     
-    std::vector<input_data_t> _data;
+    /**
+     * Reserves room for samples, so a loader that knows or can estimate the sample count fills the storage without reallocating.
+     * Without it, the storage doubles as it grows, copying every sample at each step and briefly using twice the memory.
+     * @param capacity The expected number of samples.
+     */
+    void reserve(std::size_t capacity) {
+        _data.reserve(capacity);
+    }
     
-    input_data_t _current_mean;
+    /**
+     * Adds a range of samples.
+     * @param first Iterator to the first sample.
+     * @param last Iterator to one past the last sample.
+     */
+    template<typename Iterator>
+    void append(Iterator first, Iterator last) {
+        for(; first != last; ++first) {
+            T stored = static_cast<T>(*first);
+            _data.push_back(stored);
+            _moments.add(stored);
+            if(!_counts.empty()) {
+                _counts.push_back(1);
+            }
+        }
+    }
     
-    input_data_t _current_var;
+    /**
+     * Gives direct access to the contiguous sample storage, so that hot loops can work on raw pointers.
+     * @return Pointer to the first sample.
+     */
+    const T* data() const {
+        return _data.data();
+    }
+    
+    /**
+     * Gets the running sufficient statistics of the data.
+     * @return The moments accumulated so far.
+     */
+    const SampleMoments& moments() const {
+        return _moments;
+    }
     
-    input_data_t _current_min;
+private:
+    std::vector<T, HugePageAllocator<T>> _data;
     
-    input_data_t _current_max;
+    /**
+     * The count of each value, empty unless the holder is weighted.
+     */
+    std::vector<std::size_t> _counts;
     
-    input_data_t _current_standard_deviation;
+    SampleMoments _moments;
     
 };
 
-template<typename Iterator>
-DataHolder::DataHolder(Iterator begin, Iterator end) {
-    std::size_t sz = std::distance(begin, end);
-    if(sz > 0) {
-        _data.insert(_data.begin(), begin, end);
-        _current_mean = 0;
-        _current_min = std::numeric_limits<input_data_t>::max();
-        _current_max = -std::numeric_limits<input_data_t>::max();
-        while(begin != end) {
-            _current_min = std::min(_current_min, *begin);
-            _current_max = std::max(_current_min, *begin);
-            _current_mean += (*begin) / static_cast<input_data_t>(sz);
-            ++begin;
-        }
-        _compute_variance_and_standard_deviation();
+/**
+ * The double precision holder, used everywhere unless single precision is asked for.
+ */
+typedef BasicDataHolder<input_data_t> DataHolder;
 
-    }
-    else {
-        _current_mean = 0;
-        _current_var = std::numeric_limits<input_data_t>::quiet_NaN();
-        _current_min = std::numeric_limits<input_data_t>::max();
-        _current_max = -std::numeric_limits<input_data_t>::max();
-        _current_standard_deviation = std::numeric_limits<input_data_t>::quiet_NaN();
+/**
+ * The single precision holder.
+ */
+typedef BasicDataHolder<single_data_t> SingleDataHolder;
+
+extern template class BasicDataHolder<input_data_t>;
+extern template class BasicDataHolder<single_data_t>;
+
+/**
+ * Parses one input token, following the same rules used by the DataHolder stream operator.
+ * @param token The token.
+ * @param value Receives the parsed value.
+ * @return true if the whole token is a floating point value.
+ */
+bool parse_input_value(const std::string& token, input_data_t& value);
+
+/**
+ * Reads pre-aggregated data, a value and its count per line, separated by spaces, tabs or a comma. A line with just a value counts
+ * it once. Lines that don't start with a number, such as a header, and counts that aren't positive integers are skipped.
+ * @param is The input stream.
+ * @param holder Receives the values, with add.
+ */
+template<typename T>
+void read_weighted(std::istream& is, BasicDataHolder<T>& holder);
+
+/**
+ * Estimates how many samples a text input holds, from its size and the density of numbers in its first block. The stream is left at
+ * its current position.
+ * @param is The input stream.
+ * @return The estimate, a little above the real count, or 0 if the stream can't seek, like a pipe.
+ */
+std::size_t estimate_sample_count(std::istream& is);
+
+/**
+ * Tells if a stream starts with the header of the binary input format. The stream is left at its current position.
+ *
+ * The binary format is a header followed by the samples in the native byte order: the 4 bytes "IAB1", a 4 byte unsigned
+ * integer with the size of each sample (4 for float, 8 for double), 8 reserved bytes and an 8 byte unsigned integer with
+ * the sample count.
+ * @param is The input stream.
+ * @return true if the input is binary.
+ */
+bool is_binary_input(std::istream& is);
+
+/**
+ * Reads samples in the binary input format. The header has the exact count, so the storage is reserved once.
+ * @param is The input stream, positioned at the header.
+ * @param holder Receives the samples.
+ * @return false if the header is invalid or the input ends before the count.
+ */
+template<typename T>
+bool read_binary(std::istream& is, BasicDataHolder<T>& holder);
+
+/**
+ * Writes samples in the binary input format, with the sample type of the holder.
+ * @param os The output stream.
+ * @param holder The samples.
+ * @return false if writing failed.
+ */
+template<typename T>
+bool write_binary(std::ostream& os, const BasicDataHolder<T>& holder);
+
+/**
+ * Reads a delimited table, such as a CSV or TSV file, in one pass, splitting its columns into separate holders.
+ * If any field of the first line is not a number, that line is taken as the header with the column names. Otherwise the columns are
+ * named by their position, starting at 1. Fields that are empty or not numbers are skipped, so columns may end up with different sizes.
+ * @param is The input stream.
+ * @param delimiter The field delimiter. If 0, the first of tab, comma and semicolon found in the first line.
+ * @param names Receives the column names.
+ * @param columns Receives one holder per column.
+ */
+void read_columns(std::istream& is, char delimiter, std::vector<std::string>& names, std::vector<DataHolder>& columns);
+
+template<typename T>
+template<typename Iterator>
+BasicDataHolder<T>::BasicDataHolder(Iterator begin, Iterator end): _data(begin, end), _moments() {
+    for(input_data_t value: _data) {
+        _moments.add(value);
     }
 }
 
@@ -0,0 +1,77 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "datasummary.h"
+#include <string>
+#include <vector>
+#include <limits>
+
+using namespace std;
+
+namespace {
+    const string summary_header = "input_analyser_summary";
+    
+    const int summary_version = 1;
+}
+
+bool DataSummary::merge(const DataSummary& other) {
+    DataHistogram histogram = _histogram;
+    if(!histogram.merge(other._histogram)) {
+        return false;
+    }
+    _histogram = move(histogram);
+    _moments.merge(other._moments);
+    return true;
+}
+
+ostream& operator<<(ostream& os, const DataSummary& summary) {
+    auto precision = os.precision(numeric_limits<input_data_t>::max_digits10);
+    const DataHistogram& histogram = summary._histogram;
+    size_t classes = distance(histogram.begin(), histogram.end());
+    os << summary_header << " " << summary_version << endl;
+    os << summary._moments << endl;
+    os << (classes ? histogram.begin()->lower_bound : 0) << " " << histogram.class_width() << " " << classes << endl;
+    for(auto& klass : histogram) {
+        os << klass.class_count << endl;
+    }
+    os.precision(precision);
+    return os;
+}
+
+istream& operator>>(istream& is, DataSummary& summary) {
+    string header;
+    int version = 0;
+    SampleMoments moments;
+    input_data_t lower = 0, class_width = 0;
+    size_t classes = 0;
+    is >> header >> version >> moments >> lower >> class_width >> classes;
+    if(!is || header != summary_header || version != summary_version || (classes && !(class_width > 0)) ||
+       classes > max_summary_classes) {
+        is.setstate(ios::failbit);
+        return is;
+    }
+    vector<size_t> counts(classes);
+    for(size_t& count : counts) {
+        is >> count;
+    }
+    if(is) {
+        summary = DataSummary(move(moments), classes ? DataHistogram::with_counts(lower, class_width, counts) : DataHistogram());
+    }
+    return is;
+}
@@ -0,0 +1,100 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DATASUMMARY_H
+#define DATASUMMARY_H
+#include <iostream>
+#include <utility>
+#include "samplemoments.h"
+#include "datahistogram.h"
+
+/**
+ * The most classes of a summary histogram. A class width too small for the range of the data would otherwise allocate a class per
+ * width, however many that is.
+ */
+const std::size_t max_summary_classes = 1 << 20;
+
+/**
+ * Class holding everything needed to fit a distribution to a data set without the data itself: its moments and a fixed edge
+ * histogram. Summaries of different parts of a data set can be merged, so a data set split across many files or machines can be
+ * summarized in parallel, reduced to one summary and fitted once.
+ */
+class DataSummary {
+public:
+    //Constructors
+    
+    /**
+     * Constructs an empty summary, which is the identity of merge.
+     */
+    DataSummary() = default;
+    
+    /**
+     * Constructs a summary from its parts.
+     * @param moments The moments of the data.
+     * @param histogram The histogram of the data.
+     * @pre <strong class="paramname">histogram</strong>.is_mergeable().
+     */
+    DataSummary(SampleMoments moments, DataHistogram histogram): _moments(std::move(moments)), _histogram(std::move(histogram)) {}
+    
+    /**
+     * Adds the data summarized by other to this summary.
+     * @param other The summary to merge.
+     * @return false, leaving this summary untouched, if the histograms aren't on the same grid.
+     */
+    bool merge(const DataSummary& other);
+    
+    /**
+     * Gets the moments of the data.
+     * @return The moments.
+     */
+    const SampleMoments& moments() const {
+        return _moments;
+    }
+    
+    /**
+     * Gets the histogram of the data.
+     * @return The histogram.
+     */
+    const DataHistogram& histogram() const {
+        return _histogram;
+    }
+    
+    /**
+     * Writes the summary as text, in a format read back by operator>>.
+     * @param os The output stream.
+     * @param summary The summary to write.
+     * @return The output stream <strong class="paramname">os</strong>
+     */
+    friend std::ostream& operator<<(std::ostream& os, const DataSummary& summary);
+    
+    /**
+     * Reads a summary written by operator<<. On a malformed input, sets the failbit of the stream and leaves the summary untouched.
+     * @param is The input stream.
+     * @param summary The summary to read into.
+     * @return The input stream <strong class="paramname">is</strong>
+     */
+    friend std::istream& operator>>(std::istream& is, DataSummary& summary);
+    
+private:
+    SampleMoments _moments;
+    
+    DataHistogram _histogram;
+};
+
+#endif // DATASUMMARY_H
@@ -0,0 +1,151 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "distributionmodel.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+namespace {
+    const char model_magic[4] = {'I', 'A', 'M', '1'};
+    
+    struct model_header {
+        char magic[4];
+        
+        uint32_t name_size;
+        
+        uint32_t parameter_count;
+        
+        uint32_t reserved;
+        
+        uint64_t class_count;
+    };
+    
+    template<typename T>
+    bool write_array(ostream& os, const vector<T>& values) {
+        return static_cast<bool>(os.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T)));
+    }
+    
+    template<typename T>
+    bool read_array(istream& is, vector<T>& values, size_t size) {
+        values.resize(size);
+        return static_cast<bool>(is.read(reinterpret_cast<char*>(values.data()), size * sizeof(T)));
+    }
+}
+
+HistogramSampler::HistogramSampler(const DataHistogram& histogram) {
+    size_t total = 0;
+    for(auto& klass : histogram) {
+        _lower.push_back(klass.lower_bound);
+        _upper.push_back(klass.upper_bound);
+        _keep.push_back(klass.class_count);
+        total += klass.class_count;
+    }
+    if(!total) {
+        _lower.clear();
+        _upper.clear();
+        _keep.clear();
+        return;
+    }
+    //Vose's construction: classes below the mean are topped up by the classes above it, one at a time.
+    size_t classes = _keep.size();
+    _alias.resize(classes);
+    vector<size_t> small, large;
+    for(size_t i = 0; i < classes; ++i) {
+        _keep[i] *= static_cast<input_data_t>(classes) / total;
+        _alias[i] = i;
+        (_keep[i] < 1 ? small : large).push_back(i);
+    }
+    while(!small.empty() && !large.empty()) {
+        size_t less = small.back(), more = large.back();
+        small.pop_back();
+        _alias[less] = more;
+        _keep[more] -= 1 - _keep[less];
+        if(_keep[more] < 1) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    //What is left is 1 up to rounding.
+    for(size_t i : small) {
+        _keep[i] = 1;
+    }
+    for(size_t i : large) {
+        _keep[i] = 1;
+    }
+}
+
+input_data_t HistogramSampler::generate_value(RandomEngine& engine) const {
+    uniform_real_distribution<input_data_t> unit(0, 1);
+    input_data_t pick = unit(engine) * _keep.size();
+    size_t klass = std::min(static_cast<size_t>(pick), _keep.size() - 1);
+    if(pick - klass >= _keep[klass]) {
+        klass = _alias[klass];
+    }
+    return _lower[klass] + unit(engine) * (_upper[klass] - _lower[klass]);
+}
+
+bool write_model(ostream& os, const DistributionModel& model) {
+    string name = model.distribution->get_distribution_name();
+    vector<input_data_t> parameters = model.distribution->parameters();
+    const HistogramSampler& histogram = model.histogram;
+    model_header header;
+    memcpy(header.magic, model_magic, sizeof(model_magic));
+    header.name_size = name.size();
+    header.parameter_count = parameters.size();
+    header.reserved = 0;
+    header.class_count = histogram._lower.size();
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(name.data(), name.size());
+    return write_array(os, parameters) && write_array(os, histogram._lower) && write_array(os, histogram._upper) &&
+           write_array(os, histogram._keep) && write_array(os, histogram._alias);
+}
+
+bool read_model(istream& is, DistributionModel& model) {
+    model_header header;
+    if(!is.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, model_magic, sizeof(model_magic))) {
+        return false;
+    }
+    string name(header.name_size, ' ');
+    vector<input_data_t> parameters;
+    if(!is.read(&name[0], name.size()) || !read_array(is, parameters, header.parameter_count)) {
+        return false;
+    }
+    DistributionModel read;
+    HistogramSampler& histogram = read.histogram;
+    size_t classes = header.class_count;
+    if(!read_array(is, histogram._lower, classes) || !read_array(is, histogram._upper, classes) ||
+       !read_array(is, histogram._keep, classes) || !read_array(is, histogram._alias, classes)) {
+        return false;
+    }
+    for(uint64_t alias : histogram._alias) {
+        if(alias >= classes) {
+            return false;
+        }
+    }
+    read.distribution = make_distribution(name, parameters);
+    if(!read.distribution) {
+        return false;
+    }
+    model = move(read);
+    return true;
+}
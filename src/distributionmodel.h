@@ -0,0 +1,120 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef DISTRIBUTIONMODEL_H
+#define DISTRIBUTIONMODEL_H
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "inputtypes.h"
+#include "randomengine.h"
+#include "datahistogram.h"
+#include "distributions/distribution.h"
+
+struct DistributionModel;
+
+/**
+ * Generator of values with the distribution of a histogram. A class is picked in constant time with Walker's alias method, and the
+ * value is uniform inside the class.
+ */
+class HistogramSampler {
+public:
+    /**
+     * Constructs a sampler with no classes.
+     */
+    HistogramSampler() = default;
+    
+    /**
+     * Constructs the alias table of a histogram, in O(classes).
+     * @param histogram The histogram.
+     */
+    explicit HistogramSampler(const DataHistogram& histogram);
+    
+    /**
+     * Generates a value.
+     * @param engine The engine used for the random numbers.
+     * @return The value.
+     * @pre !empty().
+     */
+    input_data_t generate_value(RandomEngine& engine) const;
+    
+    /**
+     * Checks if there are classes to sample from.
+     * @return true if the sampler has no classes.
+     */
+    bool empty() const {
+        return _lower.empty();
+    }
+    
+private:
+    friend bool write_model(std::ostream& os, const DistributionModel& model);
+    friend bool read_model(std::istream& is, DistributionModel& model);
+    
+    /**
+     * The bounds of each class.
+     */
+    std::vector<input_data_t> _lower, _upper;
+    
+    /**
+     * The probability of keeping each class once it is picked, instead of taking its alias.
+     */
+    std::vector<input_data_t> _keep;
+    
+    /**
+     * The class taken instead of each class when it isn't kept.
+     */
+    std::vector<std::uint64_t> _alias;
+};
+
+/**
+ * A fitted model: everything needed to generate values like the data, without the data. Its file format is binary and tiny, so
+ * generators can load it and start in microseconds.
+ */
+struct DistributionModel {
+    /**
+     * The fitted distribution.
+     */
+    std::shared_ptr<const Distribution> distribution;
+    
+    /**
+     * The histogram of the data, which may be empty.
+     */
+    HistogramSampler histogram;
+};
+
+/**
+ * Writes a model in the binary model format: a header with the magic "IAM1", then the name of the distribution, its parameters,
+ * and the bounds and alias table of the histogram, all in native byte order.
+ * @param os The output stream. It should be opened in binary mode.
+ * @param model The model.
+ * @return false if the stream failed.
+ */
+bool write_model(std::ostream& os, const DistributionModel& model);
+
+/**
+ * Reads a model written by write_model.
+ * @param is The input stream. It should be opened in binary mode.
+ * @param model Receives the model. It is left untouched if the model can't be read.
+ * @return false if the input isn't a model or it is truncated.
+ */
+bool read_model(std::istream& is, DistributionModel& model);
+
+#endif // DISTRIBUTIONMODEL_H
@@ -22,7 +22,7 @@ BetaDistribution::BetaDistribution(input_data_t alfa, input_data_t beta) {
     //TODO
 }
 
-input_data_t BetaDistribution::generate_value() const {
+input_data_t BetaDistribution::generate_value(RandomEngine& engine) const {
     //TODO
     return 0;
 }
@@ -31,7 +31,6 @@ input_data_t BetaDistribution::frequency_for(input_data_t value) const {
     return 0;
 }
 
-
-
-
-
+input_data_t BetaDistribution::cumulative_for(input_data_t value) const {
+    return 0;
+}
@@ -33,11 +33,14 @@ public:
     BetaDistribution(input_data_t alpha, input_data_t beta);
     virtual ~BetaDistribution() = default;
     
+    using Distribution::generate_value;
+    
     /**
      * Generates a random value following a beta distribution.
+     * @param engine The random engine to draw from.
      * @return Beta distributed random value.
      */
-    virtual input_data_t generate_value() const;
+    virtual input_data_t generate_value(RandomEngine& engine) const;
     
     /**
      * Calculates the probability distribution.
@@ -45,6 +48,20 @@ public:
      * @return The probability of value.
      */
     virtual input_data_t frequency_for(input_data_t value) const;
+    
+    /**
+     * Calculates the cumulative distribution function.
+     * @param value The value to calculate the cumulative probability.
+     * @return The probability of a value lesser than or equal to value.
+     */
+    virtual input_data_t cumulative_for(input_data_t value) const;
+    
+    /**
+     * @return The number of parameters of the distribution.
+     */
+    virtual std::size_t parameter_count() const {
+        return 2;
+    }
 };
 
 #endif // BETADISTRIBUTION_H
@@ -24,9 +24,12 @@
 #include "lognormaldistribution.h"
 #include "poissondistribution.h"
 #include "uniformdistribution.h"
+#include "maximumlikelihood.h"
+#include <algorithm>
 #include <limits>
 #include <cmath>
 #include "mathutils.h"
+#include "taskpool.h"
 
 using namespace std;
 
@@ -35,8 +38,71 @@ unique_ptr<T> make_unique(Args&&... args) {
     return unique_ptr<T>(new T(std::forward<Args>(args)...));
 }
 
-pair<unique_ptr<Distribution>, input_data_t> create_distribution(const DataHolder& dat, set<DistributionType>& desired_type, std::size_t num_cl) {
-    //If no type was supplied, we assume all.
+string distribution_type_name(DistributionType type) {
+    switch(type) {
+        case(DistributionType::TRIANGULAR): {
+            return "triangular";
+        }
+        case(DistributionType::NORMAL): {
+            return "normal";
+        }
+        case(DistributionType::UNIFORM): {
+            return "uniform";
+        }
+        case(DistributionType::EXPONENTIAL): {
+            return "exponential";
+        }
+        case(DistributionType::LOGNORMAL): {
+            return "log normal";
+        }
+        case(DistributionType::POISSON): {
+            return "poisson";
+        }
+        default: {
+            return "undefined";
+        }
+    }
+}
+
+void Distribution::cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const {
+    while(first != last) {
+        *out++ = cumulative_for(*first++);
+    }
+}
+
+void Distribution::cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const {
+    while(first != last) {
+        *out++ = cumulative_for(*first++);
+    }
+}
+
+template<typename T>
+static input_data_t sum_log_frequencies(const Distribution& dist, const T* first, const T* last) {
+    //Each chunk of the data is summed on the shared pool, and the chunks are added.
+    auto chunk_sum = [&](size_t begin, size_t end) {
+        input_data_t sum = 0;
+        for(const T* value = first + begin; value != first + end; ++value) {
+            sum += dist.log_frequency_for(*value);
+        }
+        return sum;
+    };
+    return parallel_reduce(shared_task_pool(), 0, last - first, sample_grain, static_cast<input_data_t>(0), chunk_sum,
+                           plus<input_data_t>());
+}
+
+input_data_t Distribution::log_likelihood(const single_data_t* first, const single_data_t* last) const {
+    return sum_log_frequencies(*this, first, last);
+}
+
+input_data_t Distribution::log_likelihood(const input_data_t* first, const input_data_t* last) const {
+    return sum_log_frequencies(*this, first, last);
+}
+
+template<typename T>
+static vector<unique_ptr<Distribution>> estimate_candidates(const BasicDataHolder<T>& dat, const set<DistributionType>& dsr_types,
+                                                            EstimationMethod estimation, size_t max_iterations, Profiler* profiler) {
+    //If no type was supplied, we assume all. The caller's set is left untouched, so it can be shared.
+    set<DistributionType> desired_type(dsr_types);
     if(desired_type.empty()) {
         desired_type.insert(DistributionType::TRIANGULAR);
         desired_type.insert(DistributionType::NORMAL);
@@ -45,98 +111,174 @@ pair<unique_ptr<Distribution>, input_data_t> create_distribution(const DataHolde
         desired_type.insert(DistributionType::LOGNORMAL);
         desired_type.insert(DistributionType::POISSON);
     }
-    unique_ptr<Distribution> best_distribution = nullptr;
-    auto monte_carlo_histogram = dat.generate_histogram(num_cl);
-    input_data_t best_fit = numeric_limits<input_data_t>::quiet_NaN();
-    //We initialize all those values as NaN so we don't have to recalculate them for each type.
-    input_data_t mean = numeric_limits<input_data_t>::quiet_NaN();
-    input_data_t variance = numeric_limits<input_data_t>::quiet_NaN();
-    input_data_t standard_deviation = numeric_limits<input_data_t>::quiet_NaN();
-    input_data_t min = numeric_limits<input_data_t>::quiet_NaN();
-    input_data_t max = numeric_limits<input_data_t>::quiet_NaN();
+    vector<unique_ptr<Distribution>> candidates;
+    const SampleMoments& moments = dat.moments();
     for(auto& type: desired_type) {
         unique_ptr<Distribution> dist_to_test(nullptr);
-        //Based on the current distribution, we estimate its parameters and perform the Chi Squared test.
-        //If it is better than the current best, we just swap the current best with the current distribution and update the best score.
-        //Also, each type we check on the monte carlo calculated values we check if it is NaN. If it is, we just initialize it.
-        //This prevents multiple unecessary calculations.
-        switch(type) {
-            case(DistributionType::TRIANGULAR): {
-                if(isnan(min)) {
-                    min = dat.min();
-                }
-                if(isnan(max)) {
-                    max = dat.max();
+        Profiler::ScopedPhase estimation_phase(profiler, "estimation/" + distribution_type_name(type));
+        //With maximum likelihood, the triangular, normal and lognormal are estimated from the samples. The other types, and every
+        //type when estimating by moments, only need the summary statistics kept by the holder, shared with summaries and streams.
+        if(estimation == EstimationMethod::MAXIMUM_LIKELIHOOD) {
+            switch(type) {
+                case(DistributionType::TRIANGULAR): {
+                    input_data_t mode = 3 * moments.mean() - moments.min() - moments.max();
+                    dist_to_test = triangular_maximum_likelihood(dat, mode, max_iterations);
+                    break;
                 }
-                if(isnan(mean)) {
-                    mean = dat.mean();
+                case(DistributionType::NORMAL): {
+                    dist_to_test = normal_maximum_likelihood(dat);
+                    break;
                 }
-                input_data_t mode = mean - min - max + mean + mean;
-                dist_to_test = make_unique<TriangularDistribution>(min, max, mode);
-                break;
-            }
-            case(DistributionType::NORMAL): {
-                if(isnan(mean)) {
-                    mean = dat.mean();
+                case(DistributionType::LOGNORMAL): {
+                    dist_to_test = lognormal_maximum_likelihood(dat);
+                    break;
                 }
-                if(isnan(standard_deviation)) {
-                    if(isnan(variance)) {
-                        standard_deviation = dat.standard_deviation();
-                    }
-                    else {
-                        standard_deviation = sqrt(variance);
-                    }
+                default: {
+                    break;
                 }
-                dist_to_test = make_unique<NormalDistribution>(mean, standard_deviation);
-                break;
             }
-            case(DistributionType::UNIFORM): {
-                if(isnan(min)) {
-                    min = dat.min();
-                }
-                if(isnan(max)) {
-                    max = dat.max();
-                }
-                dist_to_test = make_unique<UniformDistribution>(min, max);
-                break;
+        }
+        if(!dist_to_test) {
+            dist_to_test = estimate_distribution(type, moments);
+        }
+        candidates.push_back(move(dist_to_test));
+    }
+    return candidates;
+}
+
+template<typename T>
+pair<unique_ptr<Distribution>, input_data_t> create_distribution(const BasicDataHolder<T>& dat, const set<DistributionType>& dsr_types, std::size_t num_cl, ScoreType score,
+                                                                 EstimationMethod estimation, std::size_t max_iterations,
+                                                                 Profiler* profiler, vector<CandidateScore>* candidates) {
+    unique_ptr<Distribution> best_distribution = nullptr;
+    //The histogram is only needed by the Chi Squared test. The information criteria work on the raw samples.
+    DataHistogram monte_carlo_histogram;
+    if(score == ScoreType::CHI_SQUARED) {
+        Profiler::ScopedPhase phase(profiler, "histogram_build");
+        monte_carlo_histogram = dat.generate_histogram(num_cl);
+    }
+    //The Kolmogorov-Smirnov test needs the data sorted. We sort it once and share it among all the candidates.
+    //Weighted data keeps each count next to its value, so both vectors are sorted together.
+    vector<T> sorted_data;
+    vector<size_t> sorted_counts;
+    if(score == ScoreType::KOLMOGOROV_SMIRNOV) {
+        Profiler::ScopedPhase phase(profiler, "sort");
+        if(dat.is_weighted()) {
+            vector<pair<T, size_t>> pairs(dat.data_size());
+            for(size_t i = 0; i < dat.data_size(); ++i) {
+                pairs[i] = make_pair(dat.data()[i], dat.counts()[i]);
             }
-            case(DistributionType::EXPONENTIAL): {
-                if(isnan(mean)) {
-                    mean = dat.mean();
-                }
-                dist_to_test = make_unique<ExponentialDistribution>(1 / mean);
-                break;
+            sort(pairs.begin(), pairs.end());
+            sorted_data.reserve(pairs.size());
+            sorted_counts.reserve(pairs.size());
+            for(auto& entry : pairs) {
+                sorted_data.push_back(entry.first);
+                sorted_counts.push_back(entry.second);
             }
-            case(DistributionType::LOGNORMAL): {
-                input_data_t log_mean = 0;
-                input_data_t log_standard_dev = 0;
-                auto sz = dat.data_size();
-                for(auto value: dat) {
-                    if(value > 0) {
-                        log_mean += log(value) / static_cast<input_data_t>(sz);
-                    }
+        }
+        else {
+            sorted_data.assign(dat.begin(), dat.end());
+            parallel_sort(sorted_data);
+        }
+    }
+    vector<unique_ptr<Distribution>> to_score = estimate_candidates(dat, dsr_types, estimation, max_iterations, profiler);
+    vector<input_data_t> results(to_score.size());
+    {
+        Profiler::ScopedPhase scoring_phase(profiler, "scoring");
+        //The passes over the data split it among the workers of the shared pool, which only happens outside of a pool task, so the
+        //candidates are scored one after the other. Data that fits in a single chunk gives each pass a single thread anyway, so
+        //then the candidates are split among the workers instead.
+        size_t candidates_per_task = dat.data_size() > sample_grain ? std::max<size_t>(to_score.size(), 1) : 1;
+        parallel_for(shared_task_pool(), 0, to_score.size(), candidates_per_task, [&](size_t first, size_t last) {
+            for(size_t i = first; i < last; ++i) {
+                if(score == ScoreType::CHI_SQUARED) {
+                    results[i] = chi_squared_test(monte_carlo_histogram, *to_score[i]);
                 }
-                for(auto value : dat) {
-                    if(value > 0) {
-                        input_data_t tmp = pow(log(value) - log_mean, 2);
-                        log_standard_dev += tmp / std::max((input_data_t)1.0, (input_data_t)(sz - 1));
-                    }
+                else if(score == ScoreType::KOLMOGOROV_SMIRNOV) {
+                    results[i] = dat.is_weighted() ? kolmogorov_smirnov_test(sorted_data, sorted_counts, *to_score[i])
+                                                   : kolmogorov_smirnov_test(sorted_data, *to_score[i]);
                 }
-                dist_to_test = make_unique<LogNormalDistribution>(log_mean, log_standard_dev);
-                break;
-            }
-            case(DistributionType::POISSON): {
-                if(isnan(mean)) {
-                    mean = dat.mean();
+                else {
+                    results[i] = information_criterion(dat, *to_score[i], score);
                 }
-                dist_to_test = make_unique<PoissonDistribution>(mean);
-                break;
             }
-            default: {
-                break;
+        });
+    }
+    input_data_t best_fit = numeric_limits<input_data_t>::quiet_NaN();
+    //The candidates are compared in the order they were estimated, so a tie always goes to the same one. If one is better than the
+    //current best, we just swap the current best with it and update the best score.
+    for(size_t i = 0; i < to_score.size(); ++i) {
+        unique_ptr<Distribution>& dist_to_test = to_score[i];
+        input_data_t test_result = results[i];
+        //The best candidate is moved out, so the list gets copies, rebuilt from the parameters.
+        shared_ptr<const Distribution> copy = candidates ? make_distribution(dist_to_test->get_distribution_name(), dist_to_test->parameters())
+                                                         : nullptr;
+        if(copy) {
+            candidates->push_back({copy, test_result});
+        }
+        if(isnan(best_fit) || test_result < best_fit) {
+            best_fit = test_result;
+            best_distribution.swap(dist_to_test);
+        }
+    }
+    return make_pair(move(best_distribution), best_fit);
+}
+
+template<typename T>
+vector<pair<shared_ptr<const Distribution>, input_data_t>> sweep_class_counts(const BasicDataHolder<T>& dat,
+                                                                             const set<DistributionType>& dsr_types,
+                                                                             const DataHistogram& base, size_t first, size_t last,
+                                                                             EstimationMethod estimation, size_t max_iterations,
+                                                                             Profiler* profiler) {
+    //The parameters don't depend on the classes, so the candidates are estimated once and only scored at each resolution.
+    vector<shared_ptr<const Distribution>> candidates;
+    for(auto& candidate : estimate_candidates(dat, dsr_types, estimation, max_iterations, profiler)) {
+        candidates.push_back(move(candidate));
+    }
+    vector<pair<shared_ptr<const Distribution>, input_data_t>> results;
+    for(size_t classes = first; classes <= last; ++classes) {
+        DataHistogram histogram;
+        {
+            Profiler::ScopedPhase phase(profiler, "histogram_merge");
+            histogram = base.coarsened(classes);
+        }
+        Profiler::ScopedPhase phase(profiler, "scoring");
+        pair<shared_ptr<const Distribution>, input_data_t> best(nullptr, numeric_limits<input_data_t>::quiet_NaN());
+        for(auto& candidate : candidates) {
+            input_data_t test_result = chi_squared_test(histogram, *candidate);
+            if(isnan(best.second) || test_result < best.second) {
+                best = make_pair(candidate, test_result);
             }
         }
-        input_data_t test_result = chi_squared_test(monte_carlo_histogram, *dist_to_test);
+        results.push_back(best);
+    }
+    return results;
+}
+
+pair<unique_ptr<Distribution>, input_data_t> create_distribution(const DataSummary& summary, const set<DistributionType>& dsr_types,
+                                                                 Profiler* profiler) {
+    set<DistributionType> desired_type(dsr_types);
+    if(desired_type.empty()) {
+        desired_type.insert(DistributionType::TRIANGULAR);
+        desired_type.insert(DistributionType::NORMAL);
+        desired_type.insert(DistributionType::UNIFORM);
+        desired_type.insert(DistributionType::EXPONENTIAL);
+        desired_type.insert(DistributionType::LOGNORMAL);
+        desired_type.insert(DistributionType::POISSON);
+    }
+    unique_ptr<Distribution> best_distribution = nullptr;
+    input_data_t best_fit = numeric_limits<input_data_t>::quiet_NaN();
+    for(auto& type: desired_type) {
+        unique_ptr<Distribution> dist_to_test;
+        {
+            Profiler::ScopedPhase phase(profiler, "estimation/" + distribution_type_name(type));
+            dist_to_test = estimate_distribution(type, summary.moments());
+        }
+        if(!dist_to_test) {
+            continue;
+        }
+        Profiler::ScopedPhase phase(profiler, "scoring/" + distribution_type_name(type));
+        input_data_t test_result = chi_squared_test(summary.histogram(), *dist_to_test);
         if(isnan(best_fit) || test_result < best_fit) {
             best_fit = test_result;
             best_distribution.swap(dist_to_test);
@@ -145,24 +287,261 @@ pair<unique_ptr<Distribution>, input_data_t> create_distribution(const DataHolde
     return make_pair(move(best_distribution), best_fit);
 }
 
+unique_ptr<Distribution> make_distribution(const string& name, const vector<input_data_t>& parameters) {
+    if(name == "triangular" && parameters.size() == 3) {
+        return make_unique<TriangularDistribution>(parameters[0], parameters[1], parameters[2]);
+    }
+    if(name == "normal" && parameters.size() == 2) {
+        return make_unique<NormalDistribution>(parameters[0], parameters[1]);
+    }
+    if(name == "uniform" && parameters.size() == 2) {
+        return make_unique<UniformDistribution>(parameters[0], parameters[1]);
+    }
+    if(name == "exponential" && parameters.size() == 1) {
+        return make_unique<ExponentialDistribution>(parameters[0]);
+    }
+    if(name == "log normal" && parameters.size() == 2) {
+        return make_unique<LogNormalDistribution>(parameters[0], parameters[1]);
+    }
+    if(name == "poisson" && parameters.size() == 1) {
+        return make_unique<PoissonDistribution>(parameters[0]);
+    }
+    return nullptr;
+}
+
+unique_ptr<Distribution> estimate_distribution(DistributionType type, const SampleMoments& moments) {
+    switch(type) {
+        case(DistributionType::TRIANGULAR): {
+            input_data_t min = moments.min();
+            input_data_t max = moments.max();
+            input_data_t mode = 3 * moments.mean() - min - max;
+            //The density is zero at the bounds, so they are widened by the expected gap between samples, as the maximum likelihood
+            //estimate does. Otherwise the extreme samples would have zero likelihood. The mode doesn't move.
+            input_data_t samples = moments.total_weight();
+            input_data_t spread = samples > 1 ? (max - min) / (samples - 1) : 0;
+            return make_unique<TriangularDistribution>(min - spread, max + spread, mode);
+        }
+        case(DistributionType::NORMAL): {
+            return make_unique<NormalDistribution>(moments.mean(), moments.standard_deviation());
+        }
+        case(DistributionType::UNIFORM): {
+            return make_unique<UniformDistribution>(moments.min(), moments.max());
+        }
+        case(DistributionType::EXPONENTIAL): {
+            return make_unique<ExponentialDistribution>(1 / moments.mean());
+        }
+        case(DistributionType::LOGNORMAL): {
+            return make_unique<LogNormalDistribution>(moments.log_mean(), sqrt(moments.log_variance()));
+        }
+        case(DistributionType::POISSON): {
+            return make_unique<PoissonDistribution>(moments.mean());
+        }
+        default: {
+            return nullptr;
+        }
+    }
+}
 
 input_data_t chi_squared_test(const DataHistogram& hist, const Distribution& dist) {
     auto sz = hist.data_size();
-    input_data_t sum = 0;
+    vector<const DataHistogram::monte_carlo_class*> classes;
+    for(auto& klass : hist) {
+        classes.push_back(&klass);
+    }
     //We check the data count for the current distribution and compare it with the data count for the histogram.
     //We know that the data count for the distribution is equal to the integral of the probability function from the lower limit to the upper limit * the total amount of data, so we just compute it for every class and apply the Chi Squared test formula.
-    for(auto& klass : hist) {
-        auto fx = [&dist](input_data_t x) {
-            return dist.frequency_for(x);
-        };
-        input_data_t integral_value = integral(klass.lower_bound, klass.upper_bound, fx);
-        auto expected = integral_value * sz;
-        if(expected) {
-            sum += pow(expected - klass.class_count, 2) / static_cast<input_data_t>(expected);
-        }
-        else {
-            return numeric_limits<input_data_t>::infinity();
+    //Each integral is about a hundred density evaluations, so the pool gets a few classes per task.
+    const size_t classes_per_task = 16;
+    vector<input_data_t> terms(classes.size());
+    auto fx = [&dist](input_data_t x) {
+        return dist.frequency_for(x);
+    };
+    parallel_for(shared_task_pool(), 0, classes.size(), classes_per_task, [&](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i) {
+            input_data_t integral_value = integral(classes[i]->lower_bound, classes[i]->upper_bound, fx);
+            auto expected = integral_value * sz;
+            terms[i] = expected ? pow(expected - classes[i]->class_count, 2) / static_cast<input_data_t>(expected)
+                                : numeric_limits<input_data_t>::infinity();
         }
+    });
+    input_data_t sum = 0;
+    for(input_data_t term : terms) {
+        sum += term;
     }
     return sum;
 }
+
+template<typename T>
+input_data_t log_likelihood(const BasicDataHolder<T>& data, const Distribution& dist) {
+    if(!data.data_size()) {
+        return 0;
+    }
+    if(profile_counters::profiling_enabled.load(memory_order_relaxed)) {
+        profile_counters::pdf_evaluations.fetch_add(data.data_size(), memory_order_relaxed);
+    }
+    const size_t* counts = data.counts();
+    if(!counts) {
+        return dist.log_likelihood(data.data(), data.data() + data.data_size());
+    }
+    //Each distinct sample contributes its log density once per occurrence.
+    const T* values = data.data();
+    auto chunk_sum = [&](size_t begin, size_t end) {
+        input_data_t sum = 0;
+        for(size_t i = begin; i < end; ++i) {
+            sum += static_cast<input_data_t>(counts[i]) * dist.log_frequency_for(values[i]);
+        }
+        return sum;
+    };
+    return parallel_reduce(shared_task_pool(), 0, data.data_size(), sample_grain, static_cast<input_data_t>(0), chunk_sum,
+                           plus<input_data_t>());
+}
+
+template<typename T>
+input_data_t information_criterion(const BasicDataHolder<T>& data, const Distribution& dist, ScoreType criterion) {
+    input_data_t likelihood = log_likelihood(data, dist);
+    //A sample outside the support (or a degenerate fit) makes the candidate unusable, so it can never win.
+    if(std::isnan(likelihood) || likelihood == -numeric_limits<input_data_t>::infinity()) {
+        return numeric_limits<input_data_t>::infinity();
+    }
+    input_data_t k = static_cast<input_data_t>(dist.parameter_count());
+    if(criterion == ScoreType::BIC) {
+        return k * log(static_cast<input_data_t>(data.sample_count())) - 2 * likelihood;
+    }
+    return 2 * k - 2 * likelihood;
+}
+
+/**
+ * Kolmogorov-Smirnov statistic of sorted samples. Equal values are grouped, so each distinct value gets one evaluation of the
+ * cumulative function. below(i) is the number of samples before position i, so a value found at positions [i, j) has the empirical
+ * cumulative function below(i) / total just below it and below(j) / total at it.
+ */
+template<typename T, typename Below>
+static input_data_t kolmogorov_smirnov_statistic(const vector<T>& sorted_data, Below below, input_data_t total, const Distribution& dist) {
+    //The data is split in blocks small enough to stay in cache. Each block gets the cumulative values of its distinct values computed
+    //in a single batch call. A run of equal values belongs to the block where it starts, even if it goes on past its end.
+    const long block_size = 4096;
+    long sz = sorted_data.size();
+    long blocks = (sz + block_size - 1) / block_size;
+    input_data_t inv_total = total > 0 ? static_cast<input_data_t>(1.0) / total : 0;
+    //The cumulative function of a continuous distribution is the same just below a value and at it. A discrete one jumps at each value
+    //of its support, so just below x it is F(ceil(x) - 1).
+    bool discrete = dist.is_discrete();
+    auto chunk_statistic = [&](size_t first_block, size_t last_block) {
+        vector<T> values, previous;
+        vector<long> starts, ends;
+        vector<input_data_t> cumulative, cumulative_below;
+        input_data_t statistic = 0;
+        for(long block = first_block; block < static_cast<long>(last_block); ++block) {
+            long begin = block * block_size;
+            long end = std::min(begin + block_size, sz);
+            values.clear();
+            starts.clear();
+            ends.clear();
+            long i = begin;
+            while(i > 0 && i < end && sorted_data[i] == sorted_data[i - 1]) {
+                ++i;
+            }
+            while(i < end) {
+                long j = i + 1;
+                while(j < sz && sorted_data[j] == sorted_data[i]) {
+                    ++j;
+                }
+                values.push_back(sorted_data[i]);
+                starts.push_back(i);
+                ends.push_back(j);
+                i = j;
+            }
+            cumulative.resize(values.size());
+            dist.cumulative_for_batch(values.data(), values.data() + values.size(), cumulative.data());
+            if(discrete) {
+                previous.resize(values.size());
+                cumulative_below.resize(values.size());
+                for(size_t k = 0; k < values.size(); ++k) {
+                    previous[k] = ceil(values[k]) - 1;
+                }
+                dist.cumulative_for_batch(previous.data(), previous.data() + previous.size(), cumulative_below.data());
+            }
+            if(profile_counters::profiling_enabled.load(memory_order_relaxed)) {
+                profile_counters::cdf_evaluations.fetch_add(values.size() * (discrete ? 2 : 1), memory_order_relaxed);
+            }
+            for(size_t k = 0; k < values.size(); ++k) {
+                input_data_t at = cumulative[k];
+                input_data_t just_below = discrete ? cumulative_below[k] : at;
+                input_data_t distance = std::max(abs(just_below - below(starts[k]) * inv_total), abs(at - below(ends[k]) * inv_total));
+                statistic = std::max(statistic, distance);
+            }
+        }
+        return statistic;
+    };
+    return parallel_reduce(shared_task_pool(), 0, blocks, sample_grain / block_size, static_cast<input_data_t>(0), chunk_statistic,
+                           [](input_data_t a, input_data_t b) { return std::max(a, b); });
+}
+
+template<typename T>
+input_data_t kolmogorov_smirnov_test(const vector<T>& sorted_data, const Distribution& dist) {
+    return kolmogorov_smirnov_statistic(sorted_data, [](long i) { return static_cast<input_data_t>(i); },
+                                        static_cast<input_data_t>(sorted_data.size()), dist);
+}
+
+template<typename T>
+input_data_t kolmogorov_smirnov_test(const vector<T>& sorted_data, const vector<size_t>& sorted_counts, const Distribution& dist) {
+    //The empirical cumulative function jumps by the whole count at each value. Its levels are computed first, so the blocks
+    //can still be checked independently.
+    long sz = sorted_data.size();
+    vector<input_data_t> below(sz + 1, 0);
+    for(long i = 0; i < sz; ++i) {
+        below[i + 1] = below[i] + static_cast<input_data_t>(sorted_counts[i]);
+    }
+    return kolmogorov_smirnov_statistic(sorted_data, [&below](long i) { return below[i]; }, below[sz], dist);
+}
+
+input_data_t kolmogorov_smirnov_p_value(input_data_t statistic, size_t sample_size) {
+    input_data_t sqrt_size = sqrt(static_cast<input_data_t>(sample_size));
+    input_data_t lambda = (sqrt_size + 0.12 + 0.11 / sqrt_size) * statistic;
+    //The series converges too slowly for small lambdas, but its value is 1 for all practical purposes there.
+    if(lambda < 0.2) {
+        return 1;
+    }
+    input_data_t sum = 0;
+    input_data_t sign = 1;
+    for(int j = 1; j <= 100; ++j) {
+        input_data_t term = sign * exp(-2 * j * j * lambda * lambda);
+        sum += term;
+        if(std::abs(term) < 1e-12) {
+            break;
+        }
+        sign = -sign;
+    }
+    return std::min(std::max(2 * sum, static_cast<input_data_t>(0.0)), static_cast<input_data_t>(1.0));
+}
+
+template vector<pair<shared_ptr<const Distribution>, input_data_t>> sweep_class_counts(const BasicDataHolder<input_data_t>& dat,
+                                                                                      const set<DistributionType>& dsr_types,
+                                                                                      const DataHistogram& base, size_t first,
+                                                                                      size_t last, EstimationMethod estimation,
+                                                                                      size_t max_iterations, Profiler* profiler);
+template vector<pair<shared_ptr<const Distribution>, input_data_t>> sweep_class_counts(const BasicDataHolder<single_data_t>& dat,
+                                                                                      const set<DistributionType>& dsr_types,
+                                                                                      const DataHistogram& base, size_t first,
+                                                                                      size_t last, EstimationMethod estimation,
+                                                                                      size_t max_iterations, Profiler* profiler);
+template pair<unique_ptr<Distribution>, input_data_t> create_distribution(const BasicDataHolder<input_data_t>& dat,
+                                                                          const set<DistributionType>& dsr_types, std::size_t num_cl,
+                                                                          ScoreType score, EstimationMethod estimation,
+                                                                          std::size_t max_iterations, Profiler* profiler,
+                                                                          vector<CandidateScore>* candidates);
+template pair<unique_ptr<Distribution>, input_data_t> create_distribution(const BasicDataHolder<single_data_t>& dat,
+                                                                          const set<DistributionType>& dsr_types, std::size_t num_cl,
+                                                                          ScoreType score, EstimationMethod estimation,
+                                                                          std::size_t max_iterations, Profiler* profiler,
+                                                                          vector<CandidateScore>* candidates);
+template input_data_t kolmogorov_smirnov_test(const vector<input_data_t>& sorted_data, const Distribution& dist);
+template input_data_t kolmogorov_smirnov_test(const vector<single_data_t>& sorted_data, const Distribution& dist);
+template input_data_t kolmogorov_smirnov_test(const vector<input_data_t>& sorted_data, const vector<size_t>& sorted_counts,
+                                              const Distribution& dist);
+template input_data_t kolmogorov_smirnov_test(const vector<single_data_t>& sorted_data, const vector<size_t>& sorted_counts,
+                                              const Distribution& dist);
+template input_data_t log_likelihood(const BasicDataHolder<input_data_t>& data, const Distribution& dist);
+template input_data_t log_likelihood(const BasicDataHolder<single_data_t>& data, const Distribution& dist);
+template input_data_t information_criterion(const BasicDataHolder<input_data_t>& data, const Distribution& dist, ScoreType criterion);
+template input_data_t information_criterion(const BasicDataHolder<single_data_t>& data, const Distribution& dist, ScoreType criterion);
@@ -21,10 +21,15 @@
 #include <memory>
 #include "datahistogram.h"
 #include "dataholder.h"
+#include "datasummary.h"
 #include <set>
+#include <vector>
 #include <utility>
 #include <string>
 #include "inputtypes.h"
+#include "profiler.h"
+#include "randomengine.h"
+#include <cmath>
 
 /**
  * Enum listing the distribution types.
@@ -39,6 +44,31 @@ enum class DistributionType {
     POISSON
 };
 
+/**
+ * Returns the name of a distribution type. It is the same name returned by Distribution::get_distribution_name.
+ * @param type The distribution type.
+ * @return The name of the type.
+ */
+std::string distribution_type_name(DistributionType type);
+
+/**
+ * Enum listing the criteria that can be used to rank the candidate distributions.
+ */
+enum class ScoreType {
+    CHI_SQUARED,
+    AIC,
+    BIC,
+    KOLMOGOROV_SMIRNOV
+};
+
+/**
+ * Enum listing the methods that can be used to estimate the parameters of the candidate distributions.
+ */
+enum class EstimationMethod {
+    MOMENTS,
+    MAXIMUM_LIKELIHOOD
+};
+
 /**
  * Abstract class that represents a probability distribution.
  */
@@ -47,11 +77,21 @@ public:
     Distribution() = default;
     virtual ~Distribution() = default;
     
+    /**
+     * Calculates a random value following a certain distribution, using the engine of the calling thread.
+     * @return A random value.
+     */
+    input_data_t generate_value() const {
+        return generate_value(thread_random_engine());
+    }
+    
     /**
      * Calculates a random value following a certain distribution. Subclasses should implement this method.
+     * It must not touch any state other than the engine, so the same distribution can be shared among threads.
+     * @param engine The random engine to draw from.
      * @return A random value.
      */
-    virtual input_data_t generate_value() const = 0;
+    virtual input_data_t generate_value(RandomEngine& engine) const = 0;
     
     /**
      * Calculates the probability distribution. Subclasses should implement this method.
@@ -60,6 +100,71 @@ public:
      */
     virtual input_data_t frequency_for(input_data_t value) const = 0;
     
+    /**
+     * Calculates the logarithm of the probability distribution. Subclasses can override this when there is a cheaper closed form.
+     * @param value The value to calculate the log probability.
+     * @return The log probability of value, -infinity if value is outside the support.
+     */
+    virtual input_data_t log_frequency_for(input_data_t value) const {
+        return std::log(frequency_for(value));
+    }
+    
+    /**
+     * Calculates the cumulative distribution function. Subclasses should implement this method.
+     * @param value The value to calculate the cumulative probability.
+     * @return The probability of a value lesser than or equal to value.
+     */
+    virtual input_data_t cumulative_for(input_data_t value) const = 0;
+    
+    /**
+     * Calculates the cumulative distribution function for a batch of values. The default implementation calls cumulative_for for each value.
+     * Subclasses should override it with a loop that the compiler can vectorize. It must not start parallel regions, since it is
+     * called from inside them.
+     * @param first Pointer to the first value.
+     * @param last Pointer to one past the last value.
+     * @param out Pointer to the first position of the output, which must hold last - first values.
+     */
+    virtual void cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const;
+    
+    /**
+     * Single precision version of cumulative_for_batch. Subclasses that override one version should override both.
+     * @param first Pointer to the first value.
+     * @param last Pointer to one past the last value.
+     * @param out Pointer to the first position of the output, which must hold last - first values.
+     */
+    virtual void cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const;
+    
+    /**
+     * Calculates the total log-likelihood of a range of samples. The default implementation is a parallel reduction over log_frequency_for.
+     * Subclasses should override it with a kernel that the compiler can vectorize.
+     * @param first Pointer to the first sample.
+     * @param last Pointer to one past the last sample.
+     * @return The sum of the log probabilities of every sample, -infinity if any sample is outside the support.
+     */
+    virtual input_data_t log_likelihood(const input_data_t* first, const input_data_t* last) const;
+    
+    /**
+     * Single precision version of log_likelihood. Subclasses that override one version should override both.
+     * @param first Pointer to the first sample.
+     * @param last Pointer to one past the last sample.
+     * @return The sum of the log probabilities of every sample, -infinity if any sample is outside the support.
+     */
+    virtual input_data_t log_likelihood(const single_data_t* first, const single_data_t* last) const;
+    
+    /**
+     * Method that returns the number of estimated parameters of the distribution. It is used by the information criteria.
+     * @return The number of free parameters.
+     */
+    virtual std::size_t parameter_count() const = 0;
+    
+    /**
+     * Method that tells if the distribution only takes integer values.
+     * @return true if the distribution is discrete. The default is false.
+     */
+    virtual bool is_discrete() const {
+        return false;
+    }
+    
     /**
      * Method that returns the name of the distribution. Subclasses can choose to not implement this in which case it is simply undefined.
      * @return The name of the distribution.
@@ -75,22 +180,166 @@ public:
     virtual std::string get_parameters_str() const {
         return "undefined";
     }
+    
+    /**
+     * Method that returns the parameters of the distribution, in the order taken by its constructor. With the name, they are enough
+     * to recreate the distribution with make_distribution, without the rounding of get_parameters_str.
+     * @return The parameters, or nothing if the subclass doesn't implement it.
+     */
+    virtual std::vector<input_data_t> parameters() const {
+        return {};
+    }
+    
+    /**
+     * Method that returns the names of the parameters, in the order of parameters, so reports can label each value.
+     * @return The names, or nothing if the subclass doesn't implement it.
+     */
+    virtual std::vector<std::string> parameter_names() const {
+        return {};
+    }
+};
+
+/**
+ * Score of one of the candidates of a fit.
+ */
+struct CandidateScore {
+    /**
+     * The candidate, with the parameters estimated for the data.
+     */
+    std::shared_ptr<const Distribution> distribution;
+    
+    /**
+     * Its score. Lower is better.
+     */
+    input_data_t score;
 };
 
+/**
+ * Recreates a distribution from its name and parameters.
+ * @param name The name returned by Distribution::get_distribution_name.
+ * @param parameters The values returned by Distribution::parameters.
+ * @return The distribution, or null if the name is unknown or the number of parameters doesn't match.
+ */
+std::unique_ptr<Distribution> make_distribution(const std::string& name, const std::vector<input_data_t>& parameters);
+
+/**
+ * Estimates the parameters of a distribution from the summary statistics of the data alone, so it is O(1). These are the moment
+ * estimates of create_distribution, so fits of summaries, streams and the daemon get the same parameters as fits of the raw data.
+ * The bounds of the triangular are the extremes widened by range / (n - 1), and the lognormal uses the mean and the sample
+ * variance of the log of the positive samples.
+ * @param type The distribution type.
+ * @param moments The summary statistics of the data.
+ * @return The estimated distribution.
+ */
+std::unique_ptr<Distribution> estimate_distribution(DistributionType type, const SampleMoments& moments);
+
 /**
  * Chi Squared test for a certain distribution given a monte carlo histogram.
  */
 input_data_t chi_squared_test(const DataHistogram& hist, const Distribution& dist);
 
 /**
- * Creates distribution with the best Chi Squared score for the histogram among the desired types. If no types are supplied, it picks the best among all types
+ * Kolmogorov-Smirnov test for a certain distribution. Equal samples are evaluated once. For a discrete distribution, the empirical
+ * cumulative function just below each value is compared with the cumulative function at the previous point of the support, so
+ * the jumps of both step functions at the same values don't count as distance.
+ * @param sorted_data The samples, sorted in ascending order. It can be shared among all the tested distributions.
+ * @param dist The distribution.
+ * @return The D statistic, the biggest distance between the empirical and the distribution cumulative functions.
+ */
+template<typename T>
+input_data_t kolmogorov_smirnov_test(const std::vector<T>& sorted_data, const Distribution& dist);
+
+/**
+ * Kolmogorov-Smirnov test for pre-aggregated samples, equivalent to the test on the expanded data.
+ * @param sorted_data The values, sorted in ascending order. Equal values are grouped.
+ * @param sorted_counts How many times each value was observed, in the same order.
+ * @param dist The distribution.
+ * @return The D statistic.
+ */
+template<typename T>
+input_data_t kolmogorov_smirnov_test(const std::vector<T>& sorted_data, const std::vector<std::size_t>& sorted_counts, const Distribution& dist);
+
+/**
+ * Approximate p-value of the Kolmogorov-Smirnov D statistic, using the asymptotic Kolmogorov distribution with Stephens' correction.
+ * @param statistic The D statistic.
+ * @param sample_size The number of samples used to compute the statistic.
+ * @return The probability of observing a D at least as big if the data came from the distribution.
+ */
+input_data_t kolmogorov_smirnov_p_value(input_data_t statistic, std::size_t sample_size);
+
+/**
+ * Total log-likelihood of the data under a certain distribution.
+ * @param data The samples.
+ * @param dist The distribution.
+ * @return The log-likelihood or -infinity if some sample is outside the distribution support.
+ */
+template<typename T>
+input_data_t log_likelihood(const BasicDataHolder<T>& data, const Distribution& dist);
+
+/**
+ * Akaike or Bayesian information criterion for a certain distribution. Lower is better.
+ * @param data The samples.
+ * @param dist The distribution.
+ * @param criterion Either ScoreType::AIC or ScoreType::BIC.
+ * @return The information criterion or infinity if some sample is outside the distribution support.
+ */
+template<typename T>
+input_data_t information_criterion(const BasicDataHolder<T>& data, const Distribution& dist, ScoreType criterion);
+
+/**
+ * Creates distribution with the best score for the data among the desired types. If no types are supplied, it picks the best among all types
  * @param hist The Monte Carlo histogram.
  * @param dsr_types The types of distributions the user desires. If empty, it assumes the user wants to check all types.
  * @param num_cl The desired number of classes.
- * @return The distribution with the best Chi Squared score.
+ * @param score The criterion used to rank the candidates. Every criterion is a "lower is better" score.
+ * @param estimation The method used to estimate the parameters. Maximum likelihood starts from the moment estimates.
+ * @param max_iterations The maximum number of iterations of the maximum likelihood estimators that have no closed form.
+ * @param profiler If not null, receives the time spent estimating and scoring each candidate.
+ * @param candidates If not null, receives every candidate with its score, in the order they were tested.
+ * @return The distribution with the best score and the score itself.
+ */
+template<typename T>
+std::pair<std::unique_ptr<Distribution>, input_data_t> create_distribution(const BasicDataHolder<T>& data,
+                                                                           const std::set<DistributionType>& dsr_types, 
+                                                                           std::size_t num_cl,
+                                                                           ScoreType score = ScoreType::CHI_SQUARED,
+                                                                           EstimationMethod estimation = EstimationMethod::MOMENTS,
+                                                                           std::size_t max_iterations = 100,
+                                                                           Profiler* profiler = nullptr,
+                                                                           std::vector<CandidateScore>* candidates = nullptr);
+
+/**
+ * Fits the data at a range of class counts in one pass. The candidates are estimated once, and each class count is scored with
+ * the Chi Squared test on the base histogram with its classes merged down to that count, so the samples are never binned again.
+ * @param data The samples.
+ * @param dsr_types The types of distributions the user desires. If empty, it assumes the user wants to check all types.
+ * @param base A histogram of the data with at least last classes, ideally many more, so the merged classes have nearly equal widths.
+ * @param first The smallest class count.
+ * @param last The biggest class count.
+ * @param estimation The method used to estimate the parameters.
+ * @param max_iterations The maximum number of iterations of the maximum likelihood estimators that have no closed form.
+ * @param profiler If not null, receives the time spent estimating, merging and scoring.
+ * @return The best distribution and its score for each class count from first to last.
+ */
+template<typename T>
+std::vector<std::pair<std::shared_ptr<const Distribution>, input_data_t>> sweep_class_counts(const BasicDataHolder<T>& data,
+                                                                                            const std::set<DistributionType>& dsr_types,
+                                                                                            const DataHistogram& base,
+                                                                                            std::size_t first, std::size_t last,
+                                                                                            EstimationMethod estimation = EstimationMethod::MOMENTS,
+                                                                                            std::size_t max_iterations = 100,
+                                                                                            Profiler* profiler = nullptr);
+
+/**
+ * Creates distribution with the best Chi Squared score for a summary of the data, using the moment estimates. The data itself is not
+ * needed, so this is how merged summaries of a data set split across many files are fitted.
+ * @param summary The summary of the data.
+ * @param dsr_types The types of distributions the user desires. If empty, it assumes the user wants to check all types.
+ * @param profiler If not null, receives the time spent estimating and scoring each candidate.
+ * @return The distribution with the best score and the score itself.
  */
-std::pair<std::unique_ptr<Distribution>, input_data_t> create_distribution(const DataHolder& data, 
-                                                                           std::set<DistributionType>& dsr_types, 
-                                                                           std::size_t num_cl);
+std::pair<std::unique_ptr<Distribution>, input_data_t> create_distribution(const DataSummary& summary,
+                                                                           const std::set<DistributionType>& dsr_types,
+                                                                           Profiler* profiler = nullptr);
 
 #endif
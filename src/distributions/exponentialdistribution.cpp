@@ -20,20 +20,15 @@
 #include <cmath>
 #include <random>
 #include <limits>
+#include <functional>
+#include "taskpool.h"
 
 using namespace std;
 
-//These variables are made global to this file to preserve state (not sure if necessary).
-//Also they're implemented in an unamed namespace so they can't be accessed from outside.
-namespace {
-    random_device rd;
-    mt19937 mt(rd());
+input_data_t ExponentialDistribution::generate_value(RandomEngine& engine) const {
     uniform_real_distribution<input_data_t> dist(nextafter(numeric_limits<input_data_t>::min(), static_cast<input_data_t>(1.0)), 1);
-}
-
-input_data_t ExponentialDistribution::generate_value() const {
     //Rand is guaranteed to be greater than 0
-    input_data_t rand = dist(mt);
+    input_data_t rand = dist(engine);
     return -1 * log(rand) / _lambda;
 }
 
@@ -44,4 +39,65 @@ input_data_t ExponentialDistribution::frequency_for(input_data_t value) const {
     return _lambda * pow(M_E, -1 * _lambda * value);
 }
 
+input_data_t ExponentialDistribution::log_frequency_for(input_data_t value) const {
+    if(value < 0) {
+        return -numeric_limits<input_data_t>::infinity();
+    }
+    return log(_lambda) - _lambda * value;
+}
+
+template<typename T>
+input_data_t ExponentialDistribution::_log_likelihood(const T* first, const T* last) const {
+    //Each chunk of the data is reduced to its own log-likelihood on the shared pool, and the chunks are added.
+    const input_data_t log_lambda = log(_lambda);
+    auto chunk_likelihood = [&](size_t begin, size_t end) -> input_data_t {
+        const T* chunk = first + begin;
+        long sz = end - begin;
+        input_data_t sum = 0;
+        long outside = 0;
+        #pragma omp simd reduction (+:sum, outside)
+        for(long i = 0; i < sz; ++i) {
+            sum += chunk[i];
+            outside += chunk[i] < 0;
+        }
+        if(outside) {
+            return -numeric_limits<input_data_t>::infinity();
+        }
+        return sz * log_lambda - _lambda * sum;
+    };
+    return parallel_reduce(shared_task_pool(), 0, last - first, sample_grain, static_cast<input_data_t>(0), chunk_likelihood,
+                           plus<input_data_t>());
+}
+
+input_data_t ExponentialDistribution::log_likelihood(const input_data_t* first, const input_data_t* last) const {
+    return _log_likelihood(first, last);
+}
+
+input_data_t ExponentialDistribution::log_likelihood(const single_data_t* first, const single_data_t* last) const {
+    return _log_likelihood(first, last);
+}
+
+input_data_t ExponentialDistribution::cumulative_for(input_data_t value) const {
+    if(value < 0) {
+        return 0;
+    }
+    return 1 - exp(-_lambda * value);
+}
 
+template<typename T>
+void ExponentialDistribution::_cumulative_for_batch(const T* first, const T* last, input_data_t* out) const {
+    long sz = last - first;
+    #pragma omp simd
+    for(long i = 0; i < sz; ++i) {
+        input_data_t value = first[i] > 0 ? first[i] : 0;
+        out[i] = 1 - exp(-_lambda * value);
+    }
+}
+
+void ExponentialDistribution::cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
+
+void ExponentialDistribution::cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
@@ -18,25 +18,98 @@
 
 #include "distributions/lognormaldistribution.h"
 #include <cmath>
+#include <limits>
+#include <functional>
 #include "mathutils.h"
+#include "taskpool.h"
 
 using namespace std;
 
-input_data_t LogNormalDistribution::generate_value() const {
-    return pow(M_E, box_muller_transform(_mean, _standard_deviation));
+input_data_t LogNormalDistribution::generate_value(RandomEngine& engine) const {
+    return pow(M_E, box_muller_transform(engine, _mean, _standard_deviation));
 }
 
 input_data_t LogNormalDistribution::frequency_for(input_data_t value) const {
     if(value <= 0) {
         return 0;
     }
-    value = log(value);
-    input_data_t expo = -1 * pow((value - _mean), 2) /  (2 * pow(_standard_deviation, 2));
-    input_data_t pot = pow(M_E, expo);
+    //The density of log(value) times the 1 / value of the change of variable, so it is the exponential of log_frequency_for.
+    return exp(log_frequency_for(value));
+}
+
+input_data_t LogNormalDistribution::log_frequency_for(input_data_t value) const {
+    if(value <= 0) {
+        return -numeric_limits<input_data_t>::infinity();
+    }
     const input_data_t sqr_2pi = 2.50662827463;
-    return 1 / (_standard_deviation * sqr_2pi) * pot;
+    input_data_t log_value = log(value);
+    input_data_t dif_from_mean = log_value - _mean;
+    return -dif_from_mean * dif_from_mean / (2 * _standard_deviation * _standard_deviation) - log(_standard_deviation * sqr_2pi) - log_value;
 }
 
+template<typename T>
+input_data_t LogNormalDistribution::_log_likelihood(const T* first, const T* last) const {
+    const input_data_t sqr_2pi = 2.50662827463;
+    const input_data_t log_scale = log(_standard_deviation * sqr_2pi);
+    //Each chunk of the data is reduced to its own log-likelihood on the shared pool, and the chunks are added.
+    auto chunk_likelihood = [&](size_t begin, size_t end) -> input_data_t {
+        const T* chunk = first + begin;
+        long sz = end - begin;
+        input_data_t sum_logs = 0;
+        input_data_t sum_squares = 0;
+        long outside = 0;
+        #pragma omp simd reduction (+:sum_logs, sum_squares, outside)
+        for(long i = 0; i < sz; ++i) {
+            input_data_t value = chunk[i];
+            outside += value <= 0;
+            //Non positive values are replaced by 1 so the kernel stays branch free. The result is discarded anyway.
+            input_data_t log_value = log(value > 0 ? value : static_cast<input_data_t>(1.0));
+            input_data_t dif_from_mean = log_value - _mean;
+            sum_logs += log_value;
+            sum_squares += dif_from_mean * dif_from_mean;
+        }
+        if(outside) {
+            return -numeric_limits<input_data_t>::infinity();
+        }
+        return -sum_squares / (2 * _standard_deviation * _standard_deviation) - sz * log_scale - sum_logs;
+    };
+    return parallel_reduce(shared_task_pool(), 0, last - first, sample_grain, static_cast<input_data_t>(0), chunk_likelihood,
+                           plus<input_data_t>());
+}
 
+input_data_t LogNormalDistribution::log_likelihood(const input_data_t* first, const input_data_t* last) const {
+    return _log_likelihood(first, last);
+}
 
+input_data_t LogNormalDistribution::log_likelihood(const single_data_t* first, const single_data_t* last) const {
+    return _log_likelihood(first, last);
+}
 
+input_data_t LogNormalDistribution::cumulative_for(input_data_t value) const {
+    if(value <= 0) {
+        return 0;
+    }
+    const input_data_t sqrt_2 = 1.41421356237;
+    return erfc(-(log(value) - _mean) / (_standard_deviation * sqrt_2)) / 2;
+}
+
+template<typename T>
+void LogNormalDistribution::_cumulative_for_batch(const T* first, const T* last, input_data_t* out) const {
+    const input_data_t sqrt_2 = 1.41421356237;
+    const input_data_t scale = -1 / (_standard_deviation * sqrt_2);
+    long sz = last - first;
+    #pragma omp simd
+    for(long i = 0; i < sz; ++i) {
+        bool positive = first[i] > 0;
+        input_data_t log_value = log(positive ? first[i] : static_cast<input_data_t>(1.0));
+        out[i] = positive ? erfc((log_value - _mean) * scale) / 2 : 0;
+    }
+}
+
+void LogNormalDistribution::cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
+
+void LogNormalDistribution::cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
@@ -0,0 +1,118 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "distributions/maximumlikelihood.h"
+#include "distributions/normaldistribution.h"
+#include "distributions/lognormaldistribution.h"
+#include "distributions/triangulardistribution.h"
+#include "taskpool.h"
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+template<typename T>
+unique_ptr<Distribution> normal_maximum_likelihood(const BasicDataHolder<T>& data) {
+    const SampleMoments& moments = data.moments();
+    return unique_ptr<Distribution>(new NormalDistribution(moments.mean(), sqrt(moments.population_variance())));
+}
+
+template<typename T>
+unique_ptr<Distribution> lognormal_maximum_likelihood(const BasicDataHolder<T>& data) {
+    const SampleMoments& moments = data.moments();
+    return unique_ptr<Distribution>(new LogNormalDistribution(moments.log_mean(), sqrt(moments.log_population_variance())));
+}
+
+template<typename T>
+unique_ptr<Distribution> triangular_maximum_likelihood(const BasicDataHolder<T>& data, input_data_t initial_mode, size_t max_iterations) {
+    const SampleMoments& moments = data.moments();
+    size_t sz = data.sample_count();
+    input_data_t spread = sz > 1 ? (moments.max() - moments.min()) / static_cast<input_data_t>(sz - 1) : 0;
+    input_data_t min = moments.min() - spread;
+    input_data_t max = moments.max() + spread;
+    if(!(min < max)) {
+        return unique_ptr<Distribution>(new TriangularDistribution(min, max, min));
+    }
+    const T* first = data.data();
+    const T* last = first + data.data_size();
+    const size_t* counts = data.counts();
+    auto likelihood_for = [&](input_data_t mode) {
+        TriangularDistribution candidate(min, max, mode);
+        if(!counts) {
+            return candidate.log_likelihood(first, last);
+        }
+        auto chunk_sum = [&](size_t begin, size_t end) {
+            input_data_t sum = 0;
+            for(size_t i = begin; i < end; ++i) {
+                sum += static_cast<input_data_t>(counts[i]) * candidate.log_frequency_for(first[i]);
+            }
+            return sum;
+        };
+        return parallel_reduce(shared_task_pool(), 0, last - first, sample_grain, static_cast<input_data_t>(0), chunk_sum,
+                               plus<input_data_t>());
+    };
+    //The mode must stay strictly inside the bounds, otherwise one of the sides of the triangle has zero width.
+    input_data_t best_mode = std::min(std::max(initial_mode, min + spread / 2), max - spread / 2);
+    input_data_t best_likelihood = likelihood_for(best_mode);
+    //Golden section search over the whole support. The likelihood is only piecewise smooth, so we keep the best point
+    //ever evaluated instead of trusting the final bracket.
+    const input_data_t inv_phi = (std::sqrt(static_cast<input_data_t>(5.0)) - 1) / 2;
+    input_data_t low = min, high = max;
+    input_data_t left = high - inv_phi * (high - low);
+    input_data_t right = low + inv_phi * (high - low);
+    input_data_t left_likelihood = likelihood_for(left);
+    input_data_t right_likelihood = likelihood_for(right);
+    for(size_t i = 0; i < max_iterations; ++i) {
+        if(left_likelihood > best_likelihood) {
+            best_likelihood = left_likelihood;
+            best_mode = left;
+        }
+        if(right_likelihood > best_likelihood) {
+            best_likelihood = right_likelihood;
+            best_mode = right;
+        }
+        if(high - low <= spread) {
+            break;
+        }
+        if(left_likelihood > right_likelihood) {
+            high = right;
+            right = left;
+            right_likelihood = left_likelihood;
+            left = high - inv_phi * (high - low);
+            left_likelihood = likelihood_for(left);
+        }
+        else {
+            low = left;
+            left = right;
+            left_likelihood = right_likelihood;
+            right = low + inv_phi * (high - low);
+            right_likelihood = likelihood_for(right);
+        }
+    }
+    return unique_ptr<Distribution>(new TriangularDistribution(min, max, best_mode));
+}
+
+template unique_ptr<Distribution> normal_maximum_likelihood(const BasicDataHolder<input_data_t>& data);
+template unique_ptr<Distribution> normal_maximum_likelihood(const BasicDataHolder<single_data_t>& data);
+template unique_ptr<Distribution> lognormal_maximum_likelihood(const BasicDataHolder<input_data_t>& data);
+template unique_ptr<Distribution> lognormal_maximum_likelihood(const BasicDataHolder<single_data_t>& data);
+template unique_ptr<Distribution> triangular_maximum_likelihood(const BasicDataHolder<input_data_t>& data, input_data_t initial_mode,
+                                                                size_t max_iterations);
+template unique_ptr<Distribution> triangular_maximum_likelihood(const BasicDataHolder<single_data_t>& data, input_data_t initial_mode,
+                                                                size_t max_iterations);
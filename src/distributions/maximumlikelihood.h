@@ -0,0 +1,61 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAXIMUMLIKELIHOOD_H
+#define MAXIMUMLIKELIHOOD_H
+#include <memory>
+#include <cstddef>
+#include "distribution.h"
+#include "dataholder.h"
+#include "inputtypes.h"
+
+//Maximum likelihood estimators. The exponential, uniform and poisson moment estimates used by create_distribution are
+//already the maximum likelihood ones, so only the remaining types have a function here.
+
+/**
+ * Maximum likelihood estimate of a normal distribution. It is computed from the running moments of the data, so it is O(1).
+ * @param data The samples.
+ * @return A normal distribution with the sample mean and the population standard deviation.
+ */
+template<typename T>
+std::unique_ptr<Distribution> normal_maximum_likelihood(const BasicDataHolder<T>& data);
+
+/**
+ * Maximum likelihood estimate of a lognormal distribution. It is computed from the running moments of the log of the positive samples, so it is O(1).
+ * @param data The samples.
+ * @return A lognormal distribution with the mean and the population standard deviation of the logs.
+ */
+template<typename T>
+std::unique_ptr<Distribution> lognormal_maximum_likelihood(const BasicDataHolder<T>& data);
+
+/**
+ * Maximum likelihood estimate of the mode of a triangular distribution.
+ * Only the mode is a maximum likelihood estimate. The bounds are an approximation: the sample extremes widened by range / (n - 1),
+ * the expected gap between the extremes and the bounds of a uniform sample. At the extremes themselves the samples there would have
+ * zero likelihood, and searching the bounds as well would multiply the passes over the data.
+ * The mode has no closed form, so it is searched with golden section iterations where each step is a parallel, vectorized
+ * log-likelihood pass over the data.
+ * @param data The samples.
+ * @param initial_mode The starting guess for the mode, usually the moment estimate.
+ * @param max_iterations The maximum number of likelihood passes.
+ * @return The triangular distribution with the best likelihood found.
+ */
+template<typename T>
+std::unique_ptr<Distribution> triangular_maximum_likelihood(const BasicDataHolder<T>& data, input_data_t initial_mode, std::size_t max_iterations);
+
+#endif // MAXIMUMLIKELIHOOD_H
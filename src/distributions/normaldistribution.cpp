@@ -18,12 +18,15 @@
 
 #include "distributions/normaldistribution.h"
 #include <cmath>
+#include <limits>
+#include <functional>
 #include "mathutils.h"
+#include "taskpool.h"
 
 using namespace std;
 
-input_data_t NormalDistribution::generate_value() const {
-    return box_muller_transform(_mean, _standard_deviation);
+input_data_t NormalDistribution::generate_value(RandomEngine& engine) const {
+    return box_muller_transform(engine, _mean, _standard_deviation);
 }
 
 input_data_t NormalDistribution::frequency_for(input_data_t value) const {
@@ -33,5 +36,61 @@ input_data_t NormalDistribution::frequency_for(input_data_t value) const {
     return 1 / (_standard_deviation * sqr_2pi) * pot;
 }
 
+input_data_t NormalDistribution::log_frequency_for(input_data_t value) const {
+    const input_data_t sqr_2pi = 2.50662827463;
+    input_data_t dif_from_mean = value - _mean;
+    return -dif_from_mean * dif_from_mean / (2 * _standard_deviation * _standard_deviation) - log(_standard_deviation * sqr_2pi);
+}
+
+template<typename T>
+input_data_t NormalDistribution::_log_likelihood(const T* first, const T* last) const {
+    const input_data_t sqr_2pi = 2.50662827463;
+    long sz = last - first;
+    //Only the sum of squared deviations depends on the data, so that is the only thing the chunks compute on the shared pool.
+    auto chunk_squares = [&](size_t begin, size_t end) -> input_data_t {
+        const T* chunk = first + begin;
+        long chunk_size = end - begin;
+        input_data_t sum_squares = 0;
+        #pragma omp simd reduction (+:sum_squares)
+        for(long i = 0; i < chunk_size; ++i) {
+            input_data_t dif_from_mean = chunk[i] - _mean;
+            sum_squares += dif_from_mean * dif_from_mean;
+        }
+        return sum_squares;
+    };
+    input_data_t sum_squares = parallel_reduce(shared_task_pool(), 0, sz, sample_grain, static_cast<input_data_t>(0), chunk_squares,
+                                               plus<input_data_t>());
+    return -sum_squares / (2 * _standard_deviation * _standard_deviation) - sz * log(_standard_deviation * sqr_2pi);
+}
+
+input_data_t NormalDistribution::log_likelihood(const input_data_t* first, const input_data_t* last) const {
+    return _log_likelihood(first, last);
+}
 
+input_data_t NormalDistribution::log_likelihood(const single_data_t* first, const single_data_t* last) const {
+    return _log_likelihood(first, last);
+}
 
+input_data_t NormalDistribution::cumulative_for(input_data_t value) const {
+    const input_data_t sqrt_2 = 1.41421356237;
+    return erfc(-(value - _mean) / (_standard_deviation * sqrt_2)) / 2;
+}
+
+template<typename T>
+void NormalDistribution::_cumulative_for_batch(const T* first, const T* last, input_data_t* out) const {
+    const input_data_t sqrt_2 = 1.41421356237;
+    const input_data_t scale = -1 / (_standard_deviation * sqrt_2);
+    long sz = last - first;
+    #pragma omp simd
+    for(long i = 0; i < sz; ++i) {
+        out[i] = erfc((first[i] - _mean) * scale) / 2;
+    }
+}
+
+void NormalDistribution::cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
+
+void NormalDistribution::cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
@@ -18,44 +18,123 @@
 
 #include "distributions/poissondistribution.h"
 #include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <limits>
+#include <functional>
+#include "taskpool.h"
+#include "mathutils.h"
 
 using namespace std;
 
-//These variables are made global to this file to preserve state (not sure if necessary).
-//Also they're implemented in an unamed namespace so they can't be accessed from outside.
-namespace {
-    random_device rd;
-    mt19937 mt(rd());
+input_data_t PoissonDistribution::generate_value(RandomEngine& engine) const {
     uniform_real_distribution<input_data_t> dist(nextafter(numeric_limits<input_data_t>::min(), static_cast<input_data_t>(1.0)), 1);
-}
-
-input_data_t PoissonDistribution::generate_value() const {
     input_data_t temp = pow(M_E, -_lambda);
     int k = 0;
     input_data_t p = 1;
     do {
         ++k;
-        input_data_t random = dist(mt);
+        input_data_t random = dist(engine);
         p *= random;
     } while(p > temp);
     return k - 1;
 }
 
 input_data_t PoissonDistribution::frequency_for(input_data_t value) const {
-    int val = static_cast<long>(value);
-    if(val < 0) {
+    if(value < 0) {
         return 0;
     }
-    input_data_t temp = pow(M_E, -_lambda) * (pow(_lambda, val));
-    while(val) {
-        temp /= 1.0f * val--;
+    //In logarithms, so large counts neither overflow the power nor take a division per unit.
+    input_data_t val = floor(value);
+    return exp(val * log(_lambda) - _lambda - lgamma(val + 1));
+}
+
+input_data_t PoissonDistribution::log_frequency_for(input_data_t value) const {
+    long val = static_cast<long>(value);
+    //The pmf only applies to counts, so a fractional sample can't come from this distribution.
+    if(val < 0 || static_cast<input_data_t>(val) != value) {
+        return -numeric_limits<input_data_t>::infinity();
     }
-    return temp;
+    return val * log(_lambda) - _lambda - lgamma(static_cast<input_data_t>(val + 1));
 }
 
+template<typename T>
+input_data_t PoissonDistribution::_log_likelihood(const T* first, const T* last) const {
+    const input_data_t log_lambda = log(_lambda);
+    //Each chunk of the data is reduced to its own log-likelihood on the shared pool, and the chunks are added.
+    auto chunk_likelihood = [&](size_t begin, size_t end) -> input_data_t {
+        const T* chunk = first + begin;
+        long sz = end - begin;
+        input_data_t sum_values = 0;
+        input_data_t sum_log_factorials = 0;
+        long outside = 0;
+        for(long i = 0; i < sz; ++i) {
+            long val = static_cast<long>(chunk[i]);
+            outside += val < 0 || static_cast<input_data_t>(val) != static_cast<input_data_t>(chunk[i]);
+            sum_values += val;
+            sum_log_factorials += lgamma(static_cast<input_data_t>(val + 1));
+        }
+        if(outside) {
+            return -numeric_limits<input_data_t>::infinity();
+        }
+        return sum_values * log_lambda - sz * _lambda - sum_log_factorials;
+    };
+    return parallel_reduce(shared_task_pool(), 0, last - first, sample_grain, static_cast<input_data_t>(0), chunk_likelihood,
+                           plus<input_data_t>());
+}
 
+input_data_t PoissonDistribution::log_likelihood(const input_data_t* first, const input_data_t* last) const {
+    return _log_likelihood(first, last);
+}
 
+input_data_t PoissonDistribution::log_likelihood(const single_data_t* first, const single_data_t* last) const {
+    return _log_likelihood(first, last);
+}
 
+input_data_t PoissonDistribution::cumulative_for(input_data_t value) const {
+    if(value < 0) {
+        return 0;
+    }
+    //P(X <= val) = Q(val + 1, lambda), whose cost doesn't grow with val the way summing the probabilities does.
+    return regularized_gamma_q(floor(value) + 1, _lambda);
+}
+
+template<typename T>
+void PoissonDistribution::_cumulative_for_batch(const T* first, const T* last, input_data_t* out) const {
+    //Walking up to the next value costs a term per unit, so longer gaps evaluate the incomplete gamma function, which costs about
+    //sqrt(lambda) terms. A probability too small for the recurrence also starts over.
+    const input_data_t max_gap = 16 + sqrt(_lambda);
+    input_data_t previous = -1;
+    input_data_t term = 0;
+    input_data_t sum = 0;
+    for(; first != last; ++first, ++out) {
+        input_data_t value = *first;
+        if(value < 0) {
+            *out = 0;
+            continue;
+        }
+        value = floor(value);
+        if(previous >= 0 && value >= previous && value - previous <= max_gap && term >= numeric_limits<input_data_t>::min()) {
+            while(previous < value) {
+                ++previous;
+                term *= _lambda / previous;
+                sum += term;
+            }
+        }
+        else {
+            previous = value;
+            term = frequency_for(value);
+            sum = cumulative_for(value);
+        }
+        *out = std::min(sum, static_cast<input_data_t>(1.0));
+    }
+}
+
+void PoissonDistribution::cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
+
+void PoissonDistribution::cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
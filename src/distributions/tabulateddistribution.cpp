@@ -0,0 +1,88 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "distributions/tabulateddistribution.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace std;
+
+input_data_t inverse_cumulative(const Distribution& distribution, input_data_t probability) {
+    //The bracket grows geometrically from [-1, 1] until it holds the value, then it is halved until it is as narrow as the precision
+    //of its bounds allows. The iterations are capped since near 0 that would go down to the denormals.
+    const input_data_t limit = numeric_limits<input_data_t>::max() / 4;
+    input_data_t lower = -1, upper = 1;
+    while(lower > -limit && distribution.cumulative_for(lower) >= probability) {
+        lower *= 2;
+    }
+    while(upper < limit && distribution.cumulative_for(upper) < probability) {
+        upper *= 2;
+    }
+    for(int i = 0; i < 200; ++i) {
+        if(upper - lower <= numeric_limits<input_data_t>::epsilon() * std::max(fabs(lower), fabs(upper))) {
+            break;
+        }
+        input_data_t middle = lower + (upper - lower) / 2;
+        if(distribution.cumulative_for(middle) < probability) {
+            lower = middle;
+        }
+        else {
+            upper = middle;
+        }
+    }
+    return upper;
+}
+
+TabulatedDistribution::TabulatedDistribution(shared_ptr<const Distribution> distribution, size_t table_size):
+    _distribution(move(distribution)) {
+    if(_distribution->is_discrete() || table_size < 3) {
+        return;
+    }
+    _table.resize(table_size + 1);
+    for(size_t i = 1; i < table_size; ++i) {
+        _table[i] = inverse_cumulative(*_distribution, static_cast<input_data_t>(i) / table_size);
+    }
+    for(size_t i = 1; i + 1 < table_size; ++i) {
+        input_data_t middle = (i + 0.5) / table_size;
+        input_data_t value = _table[i] + (_table[i + 1] - _table[i]) / 2;
+        _max_error = std::max(_max_error, fabs(_distribution->cumulative_for(value) - middle));
+    }
+}
+
+input_data_t TabulatedDistribution::generate_value(RandomEngine& engine) const {
+    if(_table.empty()) {
+        return _distribution->generate_value(engine);
+    }
+    uniform_real_distribution<input_data_t> unit(0, 1);
+    input_data_t probability = 0;
+    //0 has no finite inverse for unbounded distributions.
+    while(probability == 0) {
+        probability = unit(engine);
+    }
+    size_t cells = _table.size() - 1;
+    input_data_t position = probability * cells;
+    size_t cell = static_cast<size_t>(position);
+    if(cell == 0 || cell >= cells - 1) {
+        return inverse_cumulative(*_distribution, probability);
+    }
+    return _table[cell] + (position - cell) * (_table[cell + 1] - _table[cell]);
+}
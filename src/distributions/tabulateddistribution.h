@@ -0,0 +1,145 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef TABULATEDDISTRIBUTION_H
+#define TABULATEDDISTRIBUTION_H
+#include <memory>
+#include <vector>
+#include "distribution.h"
+#include "inputtypes.h"
+
+/**
+ * Finds the value whose cumulative probability is a given probability, by bisection on the cumulative distribution function.
+ * It works for any continuous distribution, but takes about a hundred evaluations of the cumulative distribution function.
+ * @param distribution The distribution.
+ * @param probability The probability, in (0, 1).
+ * @return The smallest value x with distribution.cumulative_for(x) >= probability, to the precision of input_data_t.
+ */
+input_data_t inverse_cumulative(const Distribution& distribution, input_data_t probability);
+
+/**
+ * Decorator that makes generation cheap for any continuous distribution. The inverse of the cumulative distribution function is
+ * tabulated once, at evenly spaced probabilities, and each value is generated by inverse transform sampling: a table lookup and a
+ * linear interpolation instead of the transcendental functions of the decorated generator. The first and last cells of the table,
+ * which hold the unbounded tails, are inverted exactly. Every other method is forwarded to the decorated distribution.
+ */
+class TabulatedDistribution: public Distribution {
+public:
+    
+    /**
+     * Builds the table, with table_size cells. It takes about a hundred evaluations of the cumulative distribution function per cell.
+     * @param distribution The distribution to decorate. Discrete distributions are not tabulated, their values are generated
+     * by distribution itself.
+     * @param table_size The number of cells. The error falls about in proportion to it.
+     */
+    TabulatedDistribution(std::shared_ptr<const Distribution> distribution, std::size_t table_size = 4096);
+    
+    virtual ~TabulatedDistribution() = default;
+    
+    using Distribution::generate_value;
+    
+    /**
+     * Generates a random value by inverse transform sampling on the table.
+     * @param engine The random engine to draw from.
+     * @return A random value.
+     */
+    virtual input_data_t generate_value(RandomEngine& engine) const;
+    
+    virtual input_data_t frequency_for(input_data_t value) const {
+        return _distribution->frequency_for(value);
+    }
+    
+    virtual input_data_t log_frequency_for(input_data_t value) const {
+        return _distribution->log_frequency_for(value);
+    }
+    
+    virtual input_data_t cumulative_for(input_data_t value) const {
+        return _distribution->cumulative_for(value);
+    }
+    
+    virtual void cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const {
+        _distribution->cumulative_for_batch(first, last, out);
+    }
+    
+    virtual void cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const {
+        _distribution->cumulative_for_batch(first, last, out);
+    }
+    
+    virtual input_data_t log_likelihood(const input_data_t* first, const input_data_t* last) const {
+        return _distribution->log_likelihood(first, last);
+    }
+    
+    virtual input_data_t log_likelihood(const single_data_t* first, const single_data_t* last) const {
+        return _distribution->log_likelihood(first, last);
+    }
+    
+    virtual bool is_discrete() const {
+        return _distribution->is_discrete();
+    }
+    
+    virtual std::size_t parameter_count() const {
+        return _distribution->parameter_count();
+    }
+    
+    virtual std::string get_distribution_name() const {
+        return _distribution->get_distribution_name();
+    }
+    
+    virtual std::string get_parameters_str() const {
+        return _distribution->get_parameters_str();
+    }
+    
+    virtual std::vector<input_data_t> parameters() const {
+        return _distribution->parameters();
+    }
+    
+    virtual std::vector<std::string> parameter_names() const {
+        return _distribution->parameter_names();
+    }
+    
+    /**
+     * Gets the maximum error of the table, measured in probability: the largest difference between the probability of a cell
+     * midpoint and the cumulative probability of its interpolated value. It is an estimate of the Kolmogorov-Smirnov distance
+     * between the generated values and the decorated distribution.
+     * @return The maximum error, 0 if the distribution is discrete and wasn't tabulated.
+     */
+    input_data_t max_error() const {
+        return _max_error;
+    }
+    
+    /**
+     * Gets the number of cells of the table.
+     * @return The number of cells, 0 if the distribution is discrete and wasn't tabulated.
+     */
+    std::size_t table_size() const {
+        return _table.empty() ? 0 : _table.size() - 1;
+    }
+private:
+    std::shared_ptr<const Distribution> _distribution;
+    
+    /**
+     * The inverse cumulative distribution function at i / table_size(). The first and last values are unused.
+     */
+    std::vector<input_data_t> _table;
+    
+    input_data_t _max_error = 0;
+};
+
+#endif // TABULATEDDISTRIBUTION_H
@@ -19,19 +19,16 @@
 #include "distributions/triangulardistribution.h"
 #include <random>
 #include <cmath>
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include "taskpool.h"
 using namespace std;
 
-//These variables are made global to this file to preserve state (not sure if necessary).
-//Also they're implemented in an unamed namespace so they can't be accessed from outside.
-namespace {
-    random_device rd;
-    mt19937 mt(rd());
+input_data_t TriangularDistribution::generate_value(RandomEngine& engine) const {
     uniform_real_distribution<input_data_t> dist(0, 1);
-}
-
-input_data_t TriangularDistribution::generate_value() const {
     input_data_t temp = (_mode - _min) / (_max - _min);
-    input_data_t rand = dist(mt);
+    input_data_t rand = dist(engine);
     if(rand < temp) {
         return _min + sqrt(rand * (_max - _min)) * sqrt(_mode - _min);
     }
@@ -51,4 +48,83 @@ input_data_t TriangularDistribution::frequency_for(input_data_t value) const {
     return 2 * (_max - value) / (_max - _min) / (_max - _mode);
 }
 
+input_data_t TriangularDistribution::log_frequency_for(input_data_t value) const {
+    //A mode outside the bounds, as the moment estimate gives for skewed data, is not a density.
+    if(!(_min <= _mode && _mode <= _max)) {
+        return -numeric_limits<input_data_t>::infinity();
+    }
+    return log(frequency_for(value));
+}
+
+template<typename T>
+input_data_t TriangularDistribution::_log_likelihood(const T* first, const T* last) const {
+    if(!(_min <= _mode && _mode <= _max)) {
+        return -numeric_limits<input_data_t>::infinity();
+    }
+    const input_data_t log_left = log((_max - _min) * (_mode - _min));
+    const input_data_t log_right = log((_max - _min) * (_max - _mode));
+    //Each chunk of the data is reduced to its own log-likelihood on the shared pool, and the chunks are added.
+    auto chunk_likelihood = [&](size_t begin, size_t end) -> input_data_t {
+        const T* chunk = first + begin;
+        long sz = end - begin;
+        input_data_t sum = 0;
+        long outside = 0;
+        #pragma omp simd reduction (+:sum, outside)
+        for(long i = 0; i < sz; ++i) {
+            input_data_t value = chunk[i];
+            outside += value < _min || value > _max;
+            bool left = value <= _mode;
+            input_data_t height = left ? value - _min : _max - value;
+            sum += log(2 * height) - (left ? log_left : log_right);
+        }
+        if(outside) {
+            return -numeric_limits<input_data_t>::infinity();
+        }
+        return sum;
+    };
+    return parallel_reduce(shared_task_pool(), 0, last - first, sample_grain, static_cast<input_data_t>(0), chunk_likelihood,
+                           plus<input_data_t>());
+}
+
+input_data_t TriangularDistribution::log_likelihood(const input_data_t* first, const input_data_t* last) const {
+    return _log_likelihood(first, last);
+}
+
+input_data_t TriangularDistribution::log_likelihood(const single_data_t* first, const single_data_t* last) const {
+    return _log_likelihood(first, last);
+}
+
+input_data_t TriangularDistribution::cumulative_for(input_data_t value) const {
+    if(value <= _min) {
+        return 0;
+    }
+    if(value >= _max) {
+        return 1;
+    }
+    if(value <= _mode) {
+        return (value - _min) * (value - _min) / ((_max - _min) * (_mode - _min));
+    }
+    return 1 - (_max - value) * (_max - value) / ((_max - _min) * (_max - _mode));
+}
 
+template<typename T>
+void TriangularDistribution::_cumulative_for_batch(const T* first, const T* last, input_data_t* out) const {
+    const input_data_t left_scale = 1 / ((_max - _min) * (_mode - _min));
+    const input_data_t right_scale = 1 / ((_max - _min) * (_max - _mode));
+    long sz = last - first;
+    #pragma omp simd
+    for(long i = 0; i < sz; ++i) {
+        input_data_t value = std::min(std::max(static_cast<input_data_t>(first[i]), _min), _max);
+        input_data_t left = (value - _min) * (value - _min) * left_scale;
+        input_data_t right = 1 - (_max - value) * (_max - value) * right_scale;
+        out[i] = value <= _mode ? left : right;
+    }
+}
+
+void TriangularDistribution::cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
+
+void TriangularDistribution::cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
@@ -38,11 +38,14 @@ public:
     TriangularDistribution(input_data_t min, input_data_t max, input_data_t mode): _min(min), _max(max), _mode(mode){}
     virtual ~TriangularDistribution() = default;
     
+    using Distribution::generate_value;
+    
     /**
      * Generates a random value following a triangular distribution.
+     * @param engine The random engine to draw from.
      * @return Triangular distributed random value.
      */
-    virtual input_data_t generate_value() const;
+    virtual input_data_t generate_value(RandomEngine& engine) const;
     
     /**
      * Calculates the probability distribution.
@@ -51,6 +54,53 @@ public:
      */
     virtual input_data_t frequency_for(input_data_t value) const;
     
+    /**
+     * Calculates the cumulative distribution function.
+     * @param value The value to calculate the cumulative probability.
+     * @return The probability of a value lesser than or equal to value.
+     */
+    virtual input_data_t cumulative_for(input_data_t value) const;
+    
+    /**
+     * Calculates the cumulative distribution function for a batch of values with a vectorizable loop.
+     * @param first Pointer to the first value.
+     * @param last Pointer to one past the last value.
+     * @param out Pointer to the first position of the output.
+     */
+    virtual void cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const;
+    
+    /**
+     * Single precision version of cumulative_for_batch.
+     */
+    virtual void cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const;
+    
+    /**
+     * Calculates the logarithm of the probability distribution.
+     * @param value The value to calculate the log probability.
+     * @return The log probability of value.
+     */
+    virtual input_data_t log_frequency_for(input_data_t value) const;
+    
+    /**
+     * Calculates the total log-likelihood of a range of samples with a vectorized parallel reduction.
+     * @param first Pointer to the first sample.
+     * @param last Pointer to one past the last sample.
+     * @return The log-likelihood of the samples.
+     */
+    virtual input_data_t log_likelihood(const input_data_t* first, const input_data_t* last) const;
+    
+    /**
+     * Single precision version of log_likelihood.
+     */
+    virtual input_data_t log_likelihood(const single_data_t* first, const single_data_t* last) const;
+    
+    /**
+     * @return The number of parameters of the distribution.
+     */
+    virtual std::size_t parameter_count() const {
+        return 3;
+    }
+    
     /**
      * @return The name of the distribution.
      */
@@ -64,7 +114,28 @@ public:
     virtual std::string get_parameters_str() const {
         return "a = " + std::to_string(_min) + "; b = " + std::to_string(_max) + "; c = " + std::to_string(_mode);
     }
+    
+    /**
+     * @return The parameters, in the order of the constructor.
+     */
+    virtual std::vector<input_data_t> parameters() const {
+        return {_min, _max, _mode};
+    }
+    
+    /**
+     * Returns the names of the parameters, in the order of parameters.
+     * @return The names.
+     */
+    virtual std::vector<std::string> parameter_names() const {
+        return {"a", "b", "c"};
+    }
 private:
+    template<typename T>
+    input_data_t _log_likelihood(const T* first, const T* last) const;
+    
+    template<typename T>
+    void _cumulative_for_batch(const T* first, const T* last, input_data_t* out) const;
+    
     input_data_t _min;
     input_data_t _max;
     input_data_t _mode;
@@ -18,19 +18,17 @@
 
 #include "distributions/uniformdistribution.h"
 #include <random>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include "taskpool.h"
 
 using namespace std;
 
-//These variables are made global to this file to preserve state (not sure if necessary).
-//Also they're implemented in an unamed namespace so they can't be accessed from outside.
-namespace {
-    random_device rd;
-    mt19937 mt(rd());
+input_data_t UniformDistribution::generate_value(RandomEngine& engine) const {
     uniform_real_distribution<input_data_t> dist(0, 1);
-}
-
-input_data_t UniformDistribution::generate_value() const {
-    input_data_t random = dist(mt);
+    input_data_t random = dist(engine);
     return _min + random * (_max - _min);
 }
 
@@ -41,6 +39,66 @@ input_data_t UniformDistribution::frequency_for(input_data_t value) const {
     return 1 / (_max - _min);
 }
 
+input_data_t UniformDistribution::log_frequency_for(input_data_t value) const {
+    if(value < _min || value > _max) {
+        return -numeric_limits<input_data_t>::infinity();
+    }
+    return -log(_max - _min);
+}
 
+template<typename T>
+input_data_t UniformDistribution::_log_likelihood(const T* first, const T* last) const {
+    long sz = last - first;
+    //Only the support check depends on the data. The chunks count their samples outside it on the shared pool.
+    auto chunk_outside = [&](size_t begin, size_t end) -> long {
+        const T* chunk = first + begin;
+        long chunk_size = end - begin;
+        long outside = 0;
+        #pragma omp simd reduction (+:outside)
+        for(long i = 0; i < chunk_size; ++i) {
+            outside += chunk[i] < _min || chunk[i] > _max;
+        }
+        return outside;
+    };
+    if(parallel_reduce(shared_task_pool(), 0, sz, sample_grain, 0L, chunk_outside, plus<long>())) {
+        return -numeric_limits<input_data_t>::infinity();
+    }
+    return -sz * log(_max - _min);
+}
 
+input_data_t UniformDistribution::log_likelihood(const input_data_t* first, const input_data_t* last) const {
+    return _log_likelihood(first, last);
+}
 
+input_data_t UniformDistribution::log_likelihood(const single_data_t* first, const single_data_t* last) const {
+    return _log_likelihood(first, last);
+}
+
+input_data_t UniformDistribution::cumulative_for(input_data_t value) const {
+    if(value <= _min) {
+        return 0;
+    }
+    if(value >= _max) {
+        return 1;
+    }
+    return (value - _min) / (_max - _min);
+}
+
+template<typename T>
+void UniformDistribution::_cumulative_for_batch(const T* first, const T* last, input_data_t* out) const {
+    const input_data_t scale = 1 / (_max - _min);
+    long sz = last - first;
+    #pragma omp simd
+    for(long i = 0; i < sz; ++i) {
+        input_data_t value = std::min(std::max(static_cast<input_data_t>(first[i]), _min), _max);
+        out[i] = (value - _min) * scale;
+    }
+}
+
+void UniformDistribution::cumulative_for_batch(const input_data_t* first, const input_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
+
+void UniformDistribution::cumulative_for_batch(const single_data_t* first, const single_data_t* last, input_data_t* out) const {
+    _cumulative_for_batch(first, last, out);
+}
@@ -0,0 +1,245 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "fitcache.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    const string cache_header = "input_analyser_fit_cache";
+    
+    const int cache_version = 6;
+    
+    const size_t hash_block_size = 1 << 20;
+    
+    const uint64_t hash_seed = 0x9E3779B97F4A7C15ULL;
+    
+    /**
+     * Final mixer of MurmurHash3, so every bit of the state reaches every bit of the hash.
+     */
+    uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+    
+    uint64_t hash_word(uint64_t h, uint64_t word) {
+        word *= 0x87C37B91114253D5ULL;
+        word = (word << 31) | (word >> 33);
+        h ^= word * 0x4CF5AD432745937FULL;
+        return ((h << 27) | (h >> 37)) * 5 + 0x52DCE729;
+    }
+    
+    /**
+     * Hashes a block. Only the last block of an input may have a size that isn't a multiple of 8.
+     */
+    uint64_t hash_block(uint64_t h, const char* data, size_t size) {
+        size_t i = 0;
+        for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            h = hash_word(h, word);
+        }
+        if(i < size) {
+            uint64_t word = 0;
+            memcpy(&word, data + i, size - i);
+            h = hash_word(h, word);
+        }
+        return h;
+    }
+    
+    uint64_t hash_string(const string& text) {
+        return mix(hash_block(hash_seed, text.data(), text.size()) ^ text.size());
+    }
+    
+    /**
+     * Writes a score. operator>> can't read NaN or infinities back, so they are written as words that strtod reads.
+     */
+    void write_score(ostream& os, input_data_t value) {
+        if(value != value) {
+            os << "nan";
+        }
+        else if(value == numeric_limits<input_data_t>::infinity() || value == -numeric_limits<input_data_t>::infinity()) {
+            os << (value > 0 ? "inf" : "-inf");
+        }
+        else {
+            os << value;
+        }
+    }
+    
+    bool read_score(istream& is, input_data_t& value) {
+        string word;
+        is >> word;
+        char* end = nullptr;
+        value = strtod(word.c_str(), &end);
+        return is && end != word.c_str() && !*end;
+    }
+    
+    /**
+     * Writes a distribution as its name, on its own line since it may have spaces, followed by its parameters.
+     */
+    void write_distribution(ostream& os, const Distribution& distribution) {
+        os << distribution.get_distribution_name() << endl;
+        vector<input_data_t> parameters = distribution.parameters();
+        os << parameters.size();
+        for(input_data_t parameter : parameters) {
+            os << " " << parameter;
+        }
+        os << endl;
+    }
+    
+    shared_ptr<const Distribution> read_distribution(istream& is) {
+        string name;
+        size_t count = 0;
+        is >> ws;
+        getline(is, name);
+        is >> count;
+        if(!is) {
+            return nullptr;
+        }
+        vector<input_data_t> parameters(count);
+        for(input_data_t& parameter : parameters) {
+            is >> parameter;
+        }
+        return is ? shared_ptr<const Distribution>(make_distribution(name, parameters)) : nullptr;
+    }
+}
+
+bool hash_file(const string& path, uint64_t& hash) {
+    ifstream file(path, ios::binary);
+    if(!file) {
+        return false;
+    }
+    vector<char> block(hash_block_size);
+    uint64_t h = hash_seed;
+    uint64_t size = 0;
+    while(file) {
+        file.read(block.data(), block.size());
+        size_t read = file.gcount();
+        h = hash_block(h, block.data(), read);
+        size += read;
+    }
+    if(file.bad()) {
+        return false;
+    }
+    hash = mix(h ^ size);
+    return true;
+}
+
+string fit_cache_path(const string& cache_dir, uint64_t content_hash, const AnalyserSettings& settings, bool single_precision, bool weighted) {
+    ostringstream description;
+    description << "classes " << settings.class_count << " score " << static_cast<int>(settings.score) << " estimation ";
+    description << static_cast<int>(settings.estimation) << " iterations " << settings.max_iterations << " precision ";
+    description << (single_precision ? "float" : "double") << " distributions";
+    for(DistributionType type : settings.distributions) {
+        description << " " << static_cast<int>(type);
+    }
+    //The same file means something else when read as pairs. Plain keys are left as they were, so existing entries stay valid.
+    if(weighted) {
+        description << " weighted";
+    }
+    ostringstream path;
+    path << cache_dir;
+    if(!cache_dir.empty() && cache_dir.back() != '/') {
+        path << '/';
+    }
+    path << hex;
+    path.fill('0');
+    path.width(16);
+    path << content_hash << '-';
+    path.width(16);
+    path << hash_string(description.str()) << ".fit";
+    return path.str();
+}
+
+bool load_fit_cache(const string& path, FitCacheEntry& entry) {
+    ifstream file(path);
+    string header;
+    int version = 0;
+    file >> header >> version;
+    if(!file || header != cache_header || version != cache_version) {
+        return false;
+    }
+    FitCacheEntry read;
+    read.distribution = read_distribution(file);
+    if(!read.distribution || !read_score(file, read.score) || !read_score(file, read.log_likelihood) || !(file >> read.moments) ||
+       !read.histogram.load(file)) {
+        return false;
+    }
+    size_t count = 0;
+    file >> count;
+    read.quantiles.resize(file ? count : 0);
+    for(auto& quantile : read.quantiles) {
+        file >> quantile.first >> quantile.second;
+    }
+    file >> count;
+    for(size_t i = 0; file && i < count; ++i) {
+        CandidateScore candidate;
+        candidate.distribution = read_distribution(file);
+        if(!candidate.distribution || !read_score(file, candidate.score)) {
+            return false;
+        }
+        read.candidates.push_back(candidate);
+    }
+    if(!file) {
+        return false;
+    }
+    entry = move(read);
+    return true;
+}
+
+bool save_fit_cache(const string& path, const FitCacheEntry& entry) {
+    string temporary_path = path + ".tmp";
+    {
+        ofstream file(temporary_path);
+        file.precision(numeric_limits<input_data_t>::max_digits10);
+        file << cache_header << " " << cache_version << endl;
+        write_distribution(file, *entry.distribution);
+        write_score(file, entry.score);
+        file << " ";
+        write_score(file, entry.log_likelihood);
+        file << endl << entry.moments << endl;
+        entry.histogram.save(file);
+        file << entry.quantiles.size() << endl;
+        for(auto& quantile : entry.quantiles) {
+            file << quantile.first << " " << quantile.second << endl;
+        }
+        file << entry.candidates.size() << endl;
+        for(auto& candidate : entry.candidates) {
+            write_distribution(file, *candidate.distribution);
+            write_score(file, candidate.score);
+            file << endl;
+        }
+        if(!file) {
+            remove(temporary_path.c_str());
+            return false;
+        }
+    }
+    return rename(temporary_path.c_str(), path.c_str()) == 0;
+}
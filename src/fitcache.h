@@ -0,0 +1,109 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef FITCACHE_H
+#define FITCACHE_H
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "analyser.h"
+#include "datahistogram.h"
+#include "samplemoments.h"
+#include "distributions/distribution.h"
+
+/**
+ * Everything printed by a fit of a file, so a later run on the same content and settings can skip reading and fitting it.
+ */
+struct FitCacheEntry {
+    /**
+     * The best distribution.
+     */
+    std::shared_ptr<const Distribution> distribution;
+    
+    /**
+     * The score of the best distribution.
+     */
+    input_data_t score = 0;
+    
+    /**
+     * The log-likelihood of the data under the best distribution, NaN if it wasn't computed.
+     */
+    input_data_t log_likelihood = 0;
+    
+    /**
+     * The moments of the data.
+     */
+    SampleMoments moments;
+    
+    /**
+     * The histogram of the data.
+     */
+    DataHistogram histogram;
+    
+    /**
+     * The quantiles of the data, as pairs of probability and value.
+     */
+    std::vector<std::pair<input_data_t, input_data_t>> quantiles;
+    
+    /**
+     * Every candidate of the fit, with its score.
+     */
+    std::vector<CandidateScore> candidates;
+};
+
+/**
+ * Hashes the content of a file with a fast, non cryptographic, 64 bit hash that reads it a word at a time, in large blocks.
+ * @param path The file.
+ * @param hash Receives the hash.
+ * @return false if the file can't be read.
+ */
+bool hash_file(const std::string& path, std::uint64_t& hash);
+
+/**
+ * Gets the path of the cache entry of a content and the settings that change the result of its fit.
+ * @param cache_dir The cache directory.
+ * @param content_hash The hash of the input, from hash_file.
+ * @param settings The settings of the fit.
+ * @param single_precision If the samples are stored in single precision.
+ * @param weighted If the input is read as value and count pairs.
+ * @return The path, a file named after the two hashes in cache_dir.
+ */
+std::string fit_cache_path(const std::string& cache_dir, std::uint64_t content_hash, const AnalyserSettings& settings,
+                           bool single_precision, bool weighted = false);
+
+/**
+ * Reads a cache entry.
+ * @param path The path from fit_cache_path.
+ * @param entry Receives the entry. It is left untouched if the entry can't be read.
+ * @return false if there is no entry or it is malformed.
+ */
+bool load_fit_cache(const std::string& path, FitCacheEntry& entry);
+
+/**
+ * Writes a cache entry. It is written to a temporary file which is then renamed, so concurrent runs never read half an entry.
+ * @param path The path from fit_cache_path.
+ * @param entry The entry.
+ * @return false if the entry couldn't be written.
+ */
+bool save_fit_cache(const std::string& path, const FitCacheEntry& entry);
+
+#endif // FITCACHE_H
@@ -0,0 +1,217 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "fitreport.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+using namespace std;
+
+namespace {
+    const char report_magic[4] = {'I', 'A', 'R', '1'};
+    
+    struct report_header {
+        char magic[4];
+        
+        uint32_t score_type;
+        
+        uint32_t candidate_count;
+        
+        uint32_t reserved;
+        
+        uint64_t sample_count;
+        
+        uint64_t class_count;
+        
+        uint64_t quantile_count;
+        
+        uint64_t generated_count;
+    };
+    
+    string score_type_name(ScoreType type) {
+        switch(type) {
+            case(ScoreType::AIC): {
+                return "aic";
+            }
+            case(ScoreType::BIC): {
+                return "bic";
+            }
+            case(ScoreType::KOLMOGOROV_SMIRNOV): {
+                return "ks";
+            }
+            default: {
+                return "chi_squared";
+            }
+        }
+    }
+    
+    /**
+     * Writes a number. JSON has no NaN nor infinities, so they are written as null.
+     */
+    void write_json_value(ostream& os, input_data_t value) {
+        if(std::isfinite(value)) {
+            os << value;
+        }
+        else {
+            os << "null";
+        }
+    }
+    
+    void write_json_string(ostream& os, const string& text) {
+        os << '"';
+        for(char c : text) {
+            if(c == '"' || c == '\\') {
+                os << '\\';
+            }
+            os << c;
+        }
+        os << '"';
+    }
+    
+    void write_json_distribution(ostream& os, const Distribution& distribution, input_data_t score) {
+        vector<input_data_t> parameters = distribution.parameters();
+        vector<string> names = distribution.parameter_names();
+        os << "{\"name\": ";
+        write_json_string(os, distribution.get_distribution_name());
+        os << ", \"parameters\": {";
+        for(size_t i = 0; i < parameters.size() && i < names.size(); ++i) {
+            os << (i ? ", " : "");
+            write_json_string(os, names[i]);
+            os << ": ";
+            write_json_value(os, parameters[i]);
+        }
+        os << "}, \"score\": ";
+        write_json_value(os, score);
+        os << "}";
+    }
+    
+    template<typename T>
+    void write_value(ostream& os, T value) {
+        os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    
+    void write_binary_distribution(ostream& os, const Distribution& distribution, input_data_t score) {
+        string name = distribution.get_distribution_name();
+        vector<input_data_t> parameters = distribution.parameters();
+        write_value<uint32_t>(os, name.size());
+        write_value<uint32_t>(os, parameters.size());
+        os.write(name.data(), name.size());
+        os.write(reinterpret_cast<const char*>(parameters.data()), parameters.size() * sizeof(input_data_t));
+        write_value(os, score);
+    }
+}
+
+bool write_json_report(ostream& os, const FitReport& report) {
+    auto precision = os.precision(numeric_limits<input_data_t>::max_digits10);
+    const SampleMoments& moments = report.moments;
+    os << "{" << endl;
+    os << "  \"samples\": " << static_cast<uint64_t>(moments.total_weight()) << "," << endl;
+    os << "  \"score_type\": \"" << score_type_name(report.score_type) << "\"," << endl;
+    os << "  \"distribution\": ";
+    write_json_distribution(os, *report.distribution, report.score);
+    os << "," << endl << "  \"candidates\": [";
+    for(size_t i = 0; i < report.candidates.size(); ++i) {
+        os << (i ? "," : "") << endl << "    ";
+        write_json_distribution(os, *report.candidates[i].distribution, report.candidates[i].score);
+    }
+    os << endl << "  ]," << endl << "  \"log_likelihood\": ";
+    write_json_value(os, report.log_likelihood);
+    os << "," << endl << "  \"ks_p_value\": ";
+    write_json_value(os, report.p_value);
+    os << "," << endl << "  \"moments\": {\"mean\": ";
+    write_json_value(os, moments.mean());
+    os << ", \"variance\": ";
+    write_json_value(os, moments.variance());
+    os << ", \"standard_deviation\": ";
+    write_json_value(os, moments.standard_deviation());
+    os << ", \"min\": ";
+    write_json_value(os, moments.min());
+    os << ", \"max\": ";
+    write_json_value(os, moments.max());
+    os << "}," << endl << "  \"quantiles\": [";
+    for(size_t i = 0; i < report.quantiles.size(); ++i) {
+        os << (i ? ", " : "") << "{\"probability\": " << report.quantiles[i].first << ", \"value\": ";
+        write_json_value(os, report.quantiles[i].second);
+        os << "}";
+    }
+    os << "]," << endl << "  \"histogram\": [";
+    bool first = true;
+    for(auto& klass : report.histogram) {
+        os << (first ? "" : ",") << endl << "    {\"lower\": ";
+        write_json_value(os, klass.lower_bound);
+        os << ", \"upper\": ";
+        write_json_value(os, klass.upper_bound);
+        os << ", \"value\": ";
+        write_json_value(os, klass.value);
+        os << ", \"count\": " << klass.class_count << "}";
+        first = false;
+    }
+    os << endl << "  ]," << endl << "  \"generated\": [";
+    for(size_t i = 0; i < report.generated.size(); ++i) {
+        os << (i ? ", " : "");
+        write_json_value(os, report.generated[i]);
+    }
+    os << "]" << endl << "}" << endl;
+    os.precision(precision);
+    return static_cast<bool>(os);
+}
+
+bool write_binary_report(ostream& os, const FitReport& report) {
+    const SampleMoments& moments = report.moments;
+    vector<input_data_t> lower, upper, values;
+    vector<uint64_t> counts;
+    for(auto& klass : report.histogram) {
+        lower.push_back(klass.lower_bound);
+        upper.push_back(klass.upper_bound);
+        values.push_back(klass.value);
+        counts.push_back(klass.class_count);
+    }
+    report_header header;
+    memcpy(header.magic, report_magic, sizeof(report_magic));
+    header.score_type = static_cast<uint32_t>(report.score_type);
+    header.candidate_count = report.candidates.size();
+    header.reserved = 0;
+    header.sample_count = static_cast<uint64_t>(moments.total_weight());
+    header.class_count = counts.size();
+    header.quantile_count = report.quantiles.size();
+    header.generated_count = report.generated.size();
+    write_value(os, header);
+    input_data_t statistics[] = {report.log_likelihood, report.p_value, moments.mean(), moments.variance(), moments.standard_deviation(),
+                                 moments.min(), moments.max()};
+    os.write(reinterpret_cast<const char*>(statistics), sizeof(statistics));
+    write_binary_distribution(os, *report.distribution, report.score);
+    for(auto& candidate : report.candidates) {
+        write_binary_distribution(os, *candidate.distribution, candidate.score);
+    }
+    for(auto array : {&lower, &upper, &values}) {
+        os.write(reinterpret_cast<const char*>(array->data()), array->size() * sizeof(input_data_t));
+    }
+    os.write(reinterpret_cast<const char*>(counts.data()), counts.size() * sizeof(uint64_t));
+    for(auto& quantile : report.quantiles) {
+        write_value(os, quantile.first);
+    }
+    for(auto& quantile : report.quantiles) {
+        write_value(os, quantile.second);
+    }
+    os.write(reinterpret_cast<const char*>(report.generated.data()), report.generated.size() * sizeof(input_data_t));
+    return static_cast<bool>(os.flush());
+}
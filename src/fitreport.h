@@ -0,0 +1,120 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef FITREPORT_H
+#define FITREPORT_H
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "datahistogram.h"
+#include "samplemoments.h"
+#include "distributions/distribution.h"
+
+/**
+ * Enum listing the formats of the report of a fit.
+ */
+enum class ReportFormat {
+    TEXT,
+    JSON,
+    BINARY
+};
+
+/**
+ * Everything reported by a fit, as values, so the structured formats carry numbers instead of sentences.
+ */
+struct FitReport {
+    /**
+     * The best distribution.
+     */
+    std::shared_ptr<const Distribution> distribution;
+    
+    /**
+     * The score of the best distribution.
+     */
+    input_data_t score = 0;
+    
+    /**
+     * The criterion of the scores.
+     */
+    ScoreType score_type = ScoreType::CHI_SQUARED;
+    
+    /**
+     * Every candidate of the fit, with its score. Empty if they weren't kept.
+     */
+    std::vector<CandidateScore> candidates;
+    
+    /**
+     * The log-likelihood of the data under the best distribution, NaN if it wasn't computed.
+     */
+    input_data_t log_likelihood = 0;
+    
+    /**
+     * The Kolmogorov-Smirnov p-value of the best distribution, NaN for other scores.
+     */
+    input_data_t p_value = 0;
+    
+    /**
+     * The moments of the data.
+     */
+    SampleMoments moments;
+    
+    /**
+     * The histogram of the data.
+     */
+    DataHistogram histogram;
+    
+    /**
+     * The quantiles of the data, as pairs of probability and value.
+     */
+    std::vector<std::pair<input_data_t, input_data_t>> quantiles;
+    
+    /**
+     * The random values generated from the fit.
+     */
+    std::vector<input_data_t> generated;
+};
+
+/**
+ * Writes a report as a JSON object with the members samples, score_type, distribution, candidates, log_likelihood, ks_p_value,
+ * moments, quantiles, histogram and generated. A distribution is an object with its name, its parameters as an object from
+ * parameter name to value, and its score. Values that aren't finite, such as a missing log-likelihood, are written as null.
+ * @param os The output stream.
+ * @param report The report.
+ * @return false if the stream failed.
+ */
+bool write_json_report(std::ostream& os, const FitReport& report);
+
+/**
+ * Writes a report in the compact binary report format, in native byte order like the binary input format. It starts with a
+ * header: the magic "IAR1", the score type as a 4 byte unsigned integer (0 Chi Squared, 1 AIC, 2 BIC, 3 Kolmogorov-Smirnov), the
+ * candidate count as a 4 byte unsigned integer, 4 reserved bytes, and the sample, class, quantile and generated value counts as 8
+ * byte unsigned integers. Then come the log-likelihood, the p-value and the moments (mean, variance, standard deviation, min and
+ * max) as 8 byte doubles; the best distribution and then each candidate, each as its name size and parameter count as 4 byte
+ * unsigned integers, the name, the parameters and the score; the histogram as arrays of lower bounds, upper bounds and values, as
+ * doubles, and counts, as 8 byte unsigned integers; the quantiles as an array of probabilities and one of values; and the
+ * generated values.
+ * @param os The output stream. It should be opened in binary mode.
+ * @param report The report.
+ * @return false if the stream failed.
+ */
+bool write_binary_report(std::ostream& os, const FitReport& report);
+
+#endif // FITREPORT_H
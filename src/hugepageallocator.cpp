@@ -0,0 +1,86 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hugepageallocator.h"
+#include <atomic>
+#include <new>
+#include <cstdint>
+#include "profiler.h"
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+namespace {
+    atomic<bool> huge_pages(false);
+    
+    const size_t huge_page_size = 2 * 1024 * 1024;
+    
+    size_t round_to_huge_pages(size_t bytes) {
+        return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+}
+
+void set_huge_pages_enabled(bool enabled) {
+    huge_pages = enabled;
+}
+
+bool huge_pages_enabled() {
+    return huge_pages;
+}
+
+void* huge_page_allocate(size_t bytes, bool huge) {
+#ifdef __linux__
+    if(huge && bytes >= huge_page_size) {
+        size_t size = round_to_huge_pages(bytes);
+        //We map one extra huge page and trim both ends, so the block starts on a huge page boundary.
+        void* mapping = mmap(nullptr, size + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(mapping == MAP_FAILED) {
+            throw bad_alloc();
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+        uintptr_t aligned = (start + huge_page_size - 1) / huge_page_size * huge_page_size;
+        if(aligned != start) {
+            munmap(mapping, aligned - start);
+        }
+        size_t tail = start + huge_page_size - aligned;
+        if(tail) {
+            munmap(reinterpret_cast<void*>(aligned + size), tail);
+        }
+        madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+        if(profile_counters::profiling_enabled.load(memory_order_relaxed)) {
+            profile_counters::allocations.fetch_add(1, memory_order_relaxed);
+            profile_counters::allocated_bytes.fetch_add(size, memory_order_relaxed);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+#endif
+    return ::operator new(bytes);
+}
+
+void huge_page_deallocate(void* pointer, size_t bytes, bool huge) {
+#ifdef __linux__
+    if(huge && bytes >= huge_page_size) {
+        munmap(pointer, round_to_huge_pages(bytes));
+        return;
+    }
+#endif
+    ::operator delete(pointer);
+}
@@ -0,0 +1,120 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HUGEPAGEALLOCATOR_H
+#define HUGEPAGEALLOCATOR_H
+#include <cstddef>
+
+/**
+ * Turns huge page backed allocations on or off for allocators created from now on. Off by default.
+ * @param enabled true to use huge pages.
+ */
+void set_huge_pages_enabled(bool enabled);
+
+/**
+ * Tells if allocators created now use huge pages.
+ * @return true if huge pages are enabled.
+ */
+bool huge_pages_enabled();
+
+/**
+ * Allocates memory, like operator new. When huge is true and the block is at least one huge page, it is mapped directly, aligned
+ * to the huge page size, and the kernel is asked to back it with transparent huge pages.
+ * @param bytes The size of the block.
+ * @param huge true to use huge pages when possible.
+ * @return The block. Throws std::bad_alloc on failure.
+ */
+void* huge_page_allocate(std::size_t bytes, bool huge);
+
+/**
+ * Frees a block from huge_page_allocate.
+ * @param pointer The block.
+ * @param bytes The size it was allocated with.
+ * @param huge The flag it was allocated with.
+ */
+void huge_page_deallocate(void* pointer, std::size_t bytes, bool huge);
+
+/**
+ * Allocator for the big sample buffers. Whether it uses huge pages is decided when it is created, by huge_pages_enabled, and is
+ * kept by its copies, so memory is always freed the way it was allocated.
+ * Huge pages cut the TLB misses of the passes over hundreds of megabytes of samples. They are only used on Linux.
+ */
+template<typename T>
+class HugePageAllocator {
+public:
+    /**
+     * Typedef to value_type.
+     */
+    typedef T value_type;
+    
+    //Constructors
+    
+    /**
+     * Constructs an allocator that uses huge pages if they are enabled.
+     */
+    HugePageAllocator(): _huge(huge_pages_enabled()) {}
+    
+    /**
+     * Constructs an allocator with the same setting as other.
+     * @param other The allocator to copy the setting from.
+     */
+    template<typename U>
+    HugePageAllocator(const HugePageAllocator<U>& other): _huge(other.uses_huge_pages()) {}
+    
+    /**
+     * Allocates room for n objects.
+     * @param n The number of objects.
+     * @return Pointer to the first object.
+     */
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(huge_page_allocate(n * sizeof(T), _huge));
+    }
+    
+    /**
+     * Frees room allocated by allocate.
+     * @param pointer Pointer to the first object.
+     * @param n The number of objects it was allocated with.
+     */
+    void deallocate(T* pointer, std::size_t n) {
+        huge_page_deallocate(pointer, n * sizeof(T), _huge);
+    }
+    
+    /**
+     * Tells if this allocator uses huge pages.
+     * @return true if it uses huge pages.
+     */
+    bool uses_huge_pages() const {
+        return _huge;
+    }
+    
+private:
+    bool _huge;
+};
+
+template<typename T, typename U>
+bool operator==(const HugePageAllocator<T>& left, const HugePageAllocator<U>& right) {
+    return left.uses_huge_pages() == right.uses_huge_pages();
+}
+
+template<typename T, typename U>
+bool operator!=(const HugePageAllocator<T>& left, const HugePageAllocator<U>& right) {
+    return !(left == right);
+}
+
+#endif // HUGEPAGEALLOCATOR_H
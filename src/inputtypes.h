@@ -23,5 +23,8 @@
 
 typedef double input_data_t;
 
+//Sample type of the single precision path. Statistics and parameters are always computed in input_data_t.
+typedef float single_data_t;
+
 
 #endif
@@ -0,0 +1,103 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "integercounts.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+//Values below this are counted in the dense array, which then takes at most 512KB.
+static const uint64_t dense_limit = 1 << 16;
+//Doubles represent every integer up to this one.
+static const input_data_t max_exact_integer = static_cast<input_data_t>(1ULL << 53);
+
+IntegerCounts::IntegerCounts(): _samples(0), _distinct(0) {}
+
+bool IntegerCounts::add(input_data_t value) {
+    if(!(value >= 0 && value < max_exact_integer) || value != floor(value)) {
+        return false;
+    }
+    uint64_t integer = static_cast<uint64_t>(value);
+    if(integer < dense_limit) {
+        if(integer >= _dense.size()) {
+            _dense.resize(std::min(std::max(integer + 1, 2 * static_cast<uint64_t>(_dense.size())), dense_limit), 0);
+        }
+        _distinct += !_dense[integer]++;
+    }
+    else {
+        auto found = _sparse.find(integer);
+        if(found == _sparse.end()) {
+            if(_sparse.size() >= std::max(dense_limit, static_cast<uint64_t>(_samples / 4))) {
+                return false;
+            }
+            _sparse.emplace(integer, 1);
+            ++_distinct;
+        }
+        else {
+            ++found->second;
+        }
+    }
+    ++_samples;
+    return true;
+}
+
+template<typename T>
+void IntegerCounts::add_to(BasicDataHolder<T>& holder) {
+    for(auto& entry : _take()) {
+        holder.add(entry.first, entry.second);
+    }
+}
+
+template<typename T>
+void IntegerCounts::expand_to(BasicDataHolder<T>& holder) {
+    holder.reserve(holder.data_size() + _samples);
+    for(auto& entry : _take()) {
+        for(size_t i = 0; i < entry.second; ++i) {
+            holder << entry.first;
+        }
+    }
+}
+
+vector<pair<input_data_t, size_t>> IntegerCounts::_take() {
+    vector<pair<input_data_t, size_t>> entries;
+    entries.reserve(_distinct);
+    for(size_t i = 0; i < _dense.size(); ++i) {
+        if(_dense[i]) {
+            entries.emplace_back(static_cast<input_data_t>(i), _dense[i]);
+        }
+    }
+    vector<pair<input_data_t, size_t>> sparse;
+    sparse.reserve(_sparse.size());
+    for(auto& entry : _sparse) {
+        sparse.emplace_back(static_cast<input_data_t>(entry.first), entry.second);
+    }
+    sort(sparse.begin(), sparse.end());
+    entries.insert(entries.end(), sparse.begin(), sparse.end());
+    _dense.clear();
+    _sparse.clear();
+    _samples = 0;
+    _distinct = 0;
+    return entries;
+}
+
+template void IntegerCounts::add_to(BasicDataHolder<input_data_t>& holder);
+template void IntegerCounts::add_to(BasicDataHolder<single_data_t>& holder);
+template void IntegerCounts::expand_to(BasicDataHolder<input_data_t>& holder);
+template void IntegerCounts::expand_to(BasicDataHolder<single_data_t>& holder);
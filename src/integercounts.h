@@ -0,0 +1,102 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef INTEGERCOUNTS_H
+#define INTEGERCOUNTS_H
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "dataholder.h"
+
+/**
+ * Counts of non-negative integer samples, the usual content of count series. Small values are counted in a dense array indexed
+ * by the value and the others in a hash map, so a series of any length takes memory proportional to its distinct values only.
+ */
+class IntegerCounts {
+public:
+    //Constructors
+    
+    /**
+     * Constructs empty counts.
+     */
+    IntegerCounts();
+    
+    /**
+     * Counts a sample, if it is a non-negative integer. Samples that aren't are left out, and so are new values once the hash map
+     * holds more than a quarter of the samples, since then the counts would take more memory than the samples themselves.
+     * @param value The sample.
+     * @return false if the sample wasn't counted.
+     */
+    bool add(input_data_t value);
+    
+    /**
+     * Gets the number of samples counted.
+     * @return The number of samples.
+     */
+    std::size_t sample_count() const {
+        return _samples;
+    }
+    
+    /**
+     * Gets the number of distinct values counted.
+     * @return The number of distinct values.
+     */
+    std::size_t distinct_count() const {
+        return _distinct;
+    }
+    
+    /**
+     * Moves the counts to a holder, as a value and its count each, in ascending order. The holder becomes weighted.
+     * @param holder Receives the counts.
+     */
+    template<typename T>
+    void add_to(BasicDataHolder<T>& holder);
+    
+    /**
+     * Moves the counts to a holder as plain samples, each value repeated as many times as it was counted.
+     * @param holder Receives the samples.
+     */
+    template<typename T>
+    void expand_to(BasicDataHolder<T>& holder);
+    
+private:
+    /**
+     * Lists the counted values and their counts in ascending order, and clears the counts.
+     * @return The values and their counts.
+     */
+    std::vector<std::pair<input_data_t, std::size_t>> _take();
+    
+    std::vector<std::size_t> _dense;
+    
+    std::unordered_map<std::uint64_t, std::size_t> _sparse;
+    
+    std::size_t _samples;
+    
+    std::size_t _distinct;
+};
+
+extern template void IntegerCounts::add_to(BasicDataHolder<input_data_t>& holder);
+extern template void IntegerCounts::add_to(BasicDataHolder<single_data_t>& holder);
+extern template void IntegerCounts::expand_to(BasicDataHolder<input_data_t>& holder);
+extern template void IntegerCounts::expand_to(BasicDataHolder<single_data_t>& holder);
+
+#endif // INTEGERCOUNTS_H
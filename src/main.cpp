@@ -26,7 +26,24 @@
 #include "mathutils.h"
 #include "inputtypes.h"
 #include <iomanip>
+#include <sstream>
 #include <limits>
+#include "profiler.h"
+#include "analyser.h"
+#include "analyserdaemon.h"
+#include "streaminganalyser.h"
+#include "datasummary.h"
+#include "batchanalyser.h"
+#include "quantiles.h"
+#include "pipelinedreader.h"
+#include "taskpool.h"
+#include "fitcache.h"
+#include "fitreport.h"
+#include "distributionmodel.h"
+#include "distributions/tabulateddistribution.h"
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 
 #ifndef EXIT_FAILURE
 #define EXIT_FAILURE 1
@@ -40,11 +57,40 @@ using namespace std;
 
 void print_help(std::ostream&);
 
+std::string quantile_name(input_data_t probability);
+
+int run_streaming(std::istream& input, std::ostream& output, const AnalyserSettings& settings, std::size_t window, input_data_t decay,
+                  std::size_t refit_every, bool print_chi_square_result, const std::vector<input_data_t>& quantiles);
+
+int run_model(const std::string& model_name, const std::string& out_file_name, unsigned int generate_output, bool from_histogram,
+              unsigned int table_size, bool print_distribution);
+
+shared_ptr<const Distribution> tabulate(shared_ptr<const Distribution> distribution, unsigned int table_size);
+
+bool write_profile(const Profiler& profiler, const std::string& file_name);
+
+template<typename Sink>
+void generate_values(shared_ptr<const Distribution> distribution, const DataHistogram& histogram, bool from_histogram,
+                     unsigned int table_size, unsigned int count, Sink sink);
+
+template<typename T>
+void write_sweep(const BasicDataHolder<T>& data, const AnalyserSettings& settings, std::size_t first, std::size_t last,
+                 std::ostream& output, Profiler* profiler);
+
 //Just argument parsing in this file and setting up the system.
 
 int main(int argc, char **argv) {
-    DataHolder h;
+    bool single_precision = false;
+    bool huge_pages = false;
+    std::string binary_out_name;
     istream* stream_ptr = &cin;
+    std::string in_file_name;
+    std::string cache_dir;
+    std::string model_out_name;
+    std::string model_in_name;
+    bool generate_from_histogram = false;
+    bool weighted = false;
+    unsigned int table_size = 0;
     ostream* ostream_ptr = &cout;
     std::string out_file_name;
     ifstream file;
@@ -59,8 +105,32 @@ int main(int argc, char **argv) {
     bool print_frequency_difference = false;
     bool print_distribution = true;
     bool print_histogram = false;
+    vector<input_data_t> quantiles;
+    std::string daemon_socket;
+    unsigned int window = 0;
+    input_data_t decay = 1;
+    unsigned int refit_every = 1000;
+    input_data_t class_width = 0;
+    input_data_t range_lower = 0;
+    input_data_t range_upper = 0;
+    std::string summary_out_name;
+    vector<std::string> summary_in_names;
+    vector<std::string> batch_files;
+    bool batch = false;
+    unsigned int thread_count = 0;
+    bool table = false;
+    char delimiter = 0;
+    vector<std::string> selected_columns;
+    bool profile = false;
+    std::string profile_file_name;
     unsigned int generate_output = 0;
     unsigned int class_count = 0;
+    unsigned int sweep_first = 0;
+    unsigned int sweep_last = 0;
+    ScoreType score = ScoreType::CHI_SQUARED;
+    ReportFormat format = ReportFormat::TEXT;
+    EstimationMethod estimation = EstimationMethod::MOMENTS;
+    unsigned int max_iterations = 100;
     for(int i = 1; i < argc; ++i) {
         string cur_arg(argv[i]);
         if(cur_arg == "--help" || cur_arg == "-h") {
@@ -80,6 +150,7 @@ int main(int argc, char **argv) {
                 cerr << " which is not a file." << endl;
                 return EXIT_FAILURE;
             }
+            in_file_name = argv[i];
             stream_ptr = &file;
         }
         else if(cur_arg == "--output_file" || cur_arg == "-of") {
@@ -138,6 +209,375 @@ int main(int argc, char **argv) {
                 return EXIT_FAILURE;
             }
         }
+        else if(cur_arg == "--class_count_sweep" || cur_arg == "-ccs") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be first:last." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string sweep_str = argv[i];
+            size_t separator = sweep_str.find(':');
+            bool valid = separator != string::npos;
+            int first = 0, last = 0;
+            try {
+                size_t next_position = 0;
+                string first_str = sweep_str.substr(0, separator);
+                string last_str = valid ? sweep_str.substr(separator + 1) : "";
+                first = stoi(first_str, &next_position);
+                valid = valid && next_position == first_str.size();
+                last = stoi(last_str, &next_position);
+                valid = valid && next_position == last_str.size();
+            }
+            catch(invalid_argument& e) {
+                valid = false;
+            }
+            catch(out_of_range& e) {
+                valid = false;
+            }
+            if(!valid || !(first > 0 && first <= last)) {
+                cerr << "Expected first:last, class counts with 0 < first <= last, after " << cur_arg << ". Found: " << sweep_str << endl;
+                return EXIT_FAILURE;
+            }
+            sweep_first = first;
+            sweep_last = last;
+        }
+        else if(cur_arg == "--score" || cur_arg == "-sc") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a score name." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string score_str = argv[i];
+            if(score_str == "chi_squared") {
+                score = ScoreType::CHI_SQUARED;
+            }
+            else if(score_str == "likelihood" || score_str == "aic") {
+                score = ScoreType::AIC;
+            }
+            else if(score_str == "bic") {
+                score = ScoreType::BIC;
+            }
+            else if(score_str == "ks") {
+                score = ScoreType::KOLMOGOROV_SMIRNOV;
+            }
+            else {
+                cerr << "Expected chi_squared, likelihood, aic, bic or ks after " << cur_arg << ". Found: " << score_str << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--format" || cur_arg == "-fmt") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a format name." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string format_str = argv[i];
+            if(format_str == "text") {
+                format = ReportFormat::TEXT;
+            }
+            else if(format_str == "json") {
+                format = ReportFormat::JSON;
+            }
+            else if(format_str == "binary") {
+                format = ReportFormat::BINARY;
+            }
+            else {
+                cerr << "Expected text, json or binary after " << cur_arg << ". Found: " << format_str << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--estimator" || cur_arg == "-est") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be an estimator name." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string estimator_str = argv[i];
+            if(estimator_str == "moments") {
+                estimation = EstimationMethod::MOMENTS;
+            }
+            else if(estimator_str == "mle") {
+                estimation = EstimationMethod::MAXIMUM_LIKELIHOOD;
+            }
+            else {
+                cerr << "Expected moments or mle after " << cur_arg << ". Found: " << estimator_str << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--mle_max_iterations" || cur_arg == "-mmi") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << "should be an unsigned number." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            size_t next_position = 0;
+            string count_str = argv[i];
+            try {
+                max_iterations = stoi(count_str, &next_position);
+                if(next_position != count_str.size()) {
+                    cerr << "Expected a number after " << cur_arg << ". Found: " << count_str << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            catch(invalid_argument& e) {
+                cerr << "Expected a number after " << cur_arg << ". Found: " << count_str << endl;
+                return EXIT_FAILURE;
+            }
+            catch(out_of_range& e) {
+                cerr << "Couldn't set number of iterations. " << count_str << " is too big." << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--daemon" || cur_arg == "-d") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a socket path." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            daemon_socket = argv[i];
+        }
+        else if(cur_arg == "--batch" || cur_arg == "-b") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a file name or pattern." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            if(!expand_batch_pattern(argv[i], batch_files)) {
+                cerr << "No file matches " << argv[i] << "." << endl;
+                return EXIT_FAILURE;
+            }
+            batch = true;
+        }
+        else if(cur_arg == "--batch_list" || cur_arg == "-bl") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a file name." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            ifstream list_file(argv[i]);
+            if(!list_file) {
+                cerr << "Error opening " << argv[i] << "." << endl;
+                return EXIT_FAILURE;
+            }
+            read_batch_list(list_file, batch_files);
+            batch = true;
+        }
+        else if(cur_arg == "--precision" || cur_arg == "-prec") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be float or double." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string precision_str = argv[i];
+            if(precision_str != "float" && precision_str != "double") {
+                cerr << "Expected float or double after " << cur_arg << ". Found: " << precision_str << endl;
+                return EXIT_FAILURE;
+            }
+            single_precision = precision_str == "float";
+        }
+        else if(cur_arg == "--huge_pages" || cur_arg == "-hp") {
+            huge_pages = true;
+        }
+        else if(cur_arg == "--write_binary" || cur_arg == "-wb") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a file name." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            binary_out_name = argv[i];
+        }
+        else if(cur_arg == "--weighted" || cur_arg == "-w") {
+            weighted = true;
+        }
+        else if(cur_arg == "--cache_dir" || cur_arg == "-cd") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a directory." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            cache_dir = argv[i];
+        }
+        else if(cur_arg == "--save_model" || cur_arg == "-sm") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a file name." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            model_out_name = argv[i];
+        }
+        else if(cur_arg == "--load_model" || cur_arg == "-lm") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a file name." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            model_in_name = argv[i];
+        }
+        else if(cur_arg == "--generate_from_histogram" || cur_arg == "-gh") {
+            generate_from_histogram = true;
+        }
+        else if(cur_arg == "--tabulate" || cur_arg == "-tab") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be an unsigned number." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            size_t next_position = 0;
+            string size_str = argv[i];
+            try {
+                table_size = stoi(size_str, &next_position);
+                if(next_position != size_str.size() || table_size < 3) {
+                    cerr << "Expected a number of at least 3 after " << cur_arg << ". Found: " << size_str << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            catch(invalid_argument& e) {
+                cerr << "Expected a number after " << cur_arg << ". Found: " << size_str << endl;
+                return EXIT_FAILURE;
+            }
+            catch(out_of_range& e) {
+                cerr << "Couldn't set the table size. " << size_str << " is too big." << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--columns" || cur_arg == "-col") {
+            table = true;
+        }
+        else if(cur_arg == "--delimiter" || cur_arg == "-dl") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a character or tab." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string delimiter_str = argv[i];
+            if(delimiter_str != "tab" && delimiter_str.size() != 1) {
+                cerr << "Expected a single character or tab after " << cur_arg << ". Found: " << delimiter_str << endl;
+                return EXIT_FAILURE;
+            }
+            delimiter = delimiter_str == "tab" ? '\t' : delimiter_str[0];
+            table = true;
+        }
+        else if(cur_arg == "--column" || cur_arg == "-cl") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a column name or position." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            selected_columns.push_back(argv[i]);
+            table = true;
+        }
+        else if(cur_arg == "--threads" || cur_arg == "-j") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << "should be an unsigned number." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            size_t next_position = 0;
+            string count_str = argv[i];
+            try {
+                thread_count = stoi(count_str, &next_position);
+                if(next_position != count_str.size()) {
+                    cerr << "Expected a number after " << cur_arg << ". Found: " << count_str << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            catch(invalid_argument& e) {
+                cerr << "Expected a number after " << cur_arg << ". Found: " << count_str << endl;
+                return EXIT_FAILURE;
+            }
+            catch(out_of_range& e) {
+                cerr << "Couldn't set " << cur_arg << ". " << count_str << " is too big." << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--write_summary" || cur_arg == "-ws" || cur_arg == "--read_summary" || cur_arg == "-rs") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a file name." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            if(cur_arg == "--write_summary" || cur_arg == "-ws") {
+                summary_out_name = argv[i];
+            }
+            else {
+                summary_in_names.push_back(argv[i]);
+            }
+        }
+        else if(cur_arg == "--class_width" || cur_arg == "-cw") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a positive number." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string width_str = argv[i];
+            if(!parse_input_value(width_str, class_width) || !(class_width > 0)) {
+                cerr << "Expected a positive number after " << cur_arg << ". Found: " << width_str << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--histogram_range" || cur_arg == "-hr") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be lower:upper." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string range_str = argv[i];
+            size_t separator = range_str.find(':');
+            if(separator == string::npos || !parse_input_value(range_str.substr(0, separator), range_lower) ||
+               !parse_input_value(range_str.substr(separator + 1), range_upper) || !(range_lower < range_upper)) {
+                cerr << "Expected lower:upper, with lower < upper, after " << cur_arg << ". Found: " << range_str << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--window" || cur_arg == "-win" || cur_arg == "--refit_every" || cur_arg == "-rfe") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << "should be an unsigned number." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            size_t next_position = 0;
+            string count_str = argv[i];
+            unsigned int& target = cur_arg == "--window" || cur_arg == "-win" ? window : refit_every;
+            try {
+                target = stoi(count_str, &next_position);
+                if(next_position != count_str.size() || !target) {
+                    cerr << "Expected a positive number after " << cur_arg << ". Found: " << count_str << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            catch(invalid_argument& e) {
+                cerr << "Expected a number after " << cur_arg << ". Found: " << count_str << endl;
+                return EXIT_FAILURE;
+            }
+            catch(out_of_range& e) {
+                cerr << "Couldn't set " << cur_arg << ". " << count_str << " is too big." << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--decay" || cur_arg == "-dec") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a number in (0, 1)." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string decay_str = argv[i];
+            if(!parse_input_value(decay_str, decay) || !(decay > 0 && decay < 1)) {
+                cerr << "Expected a number in (0, 1) after " << cur_arg << ". Found: " << decay_str << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(cur_arg == "--profile" || cur_arg == "-prof") {
+            profile = true;
+        }
+        else if(cur_arg == "--profile_file" || cur_arg == "-proff") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a file name." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            profile = true;
+            profile_file_name = argv[i];
+        }
         else if(cur_arg == "--print_var" || cur_arg == "-pvr" || cur_arg == "--print_variance") {
             print_var = true;
         }
@@ -183,6 +623,26 @@ int main(int argc, char **argv) {
         else if(cur_arg == "--poisson" || cur_arg == "-psn") {
             desired_distributions.insert(DistributionType::POISSON);
         }
+        else if(cur_arg == "--print_quantiles" || cur_arg == "-pq") {
+            if((++i) == argc) {
+                cerr << "Error parsing arguments. Argument after " << cur_arg << " should be a comma separated list of probabilities." << endl;
+                cerr << "Found: None." << endl;
+                return EXIT_FAILURE;
+            }
+            string list_str = argv[i];
+            size_t start = 0;
+            while(start <= list_str.size()) {
+                size_t end = list_str.find(',', start);
+                end = end == string::npos ? list_str.size() : end;
+                input_data_t probability = 0;
+                if(!parse_input_value(list_str.substr(start, end - start), probability) || !(probability >= 0 && probability <= 1)) {
+                    cerr << "Expected probabilities between 0 and 1 after " << cur_arg << ". Found: " << list_str << endl;
+                    return EXIT_FAILURE;
+                }
+                quantiles.push_back(probability);
+                start = end + 1;
+            }
+        }
         else if(cur_arg == "--print_histogram" || cur_arg == "-ph") {
             print_histogram = true;
         }
@@ -203,34 +663,453 @@ int main(int argc, char **argv) {
             return EXIT_FAILURE;
         }
     }
-    istream& input = *stream_ptr;
-    while(input.peek() != EOF) {
-        input >> h;
-        if(input.fail()) {
-            input.clear();
-            input.ignore();
+    //Single fits split their candidates and data among the workers of the shared pool, so it gets the same limit.
+    set_shared_task_pool_threads(thread_count);
+    AnalyserSettings settings;
+    settings.distributions = desired_distributions;
+    settings.class_count = class_count;
+    settings.score = score;
+    settings.estimation = estimation;
+    settings.max_iterations = max_iterations;
+    if(weighted && (batch || table || window || decay < 1 || !summary_out_name.empty() || !summary_in_names.empty() ||
+                    !binary_out_name.empty())) {
+        cerr << "--weighted only applies to a single fit. It can't be combined with batch, table, streaming, summary or binary modes." << endl;
+        return EXIT_FAILURE;
+    }
+    if(sweep_last && (batch || table || window || decay < 1 || !summary_out_name.empty() || !summary_in_names.empty() ||
+                      !binary_out_name.empty() || !model_in_name.empty())) {
+        cerr << "--class_count_sweep only applies to a single fit. It can't be combined with batch, table, streaming, summary, binary or model modes." << endl;
+        return EXIT_FAILURE;
+    }
+    if(format != ReportFormat::TEXT && (batch || table || window || decay < 1 || !summary_out_name.empty() || !summary_in_names.empty() ||
+                                        !binary_out_name.empty() || !model_in_name.empty() || sweep_last || !daemon_socket.empty())) {
+        cerr << "--format only applies to the report of a single fit." << endl;
+        return EXIT_FAILURE;
+    }
+    if(!quantiles.empty() && (batch || table || !summary_out_name.empty() || !summary_in_names.empty() || !binary_out_name.empty() ||
+                              !model_in_name.empty() || sweep_last || !daemon_socket.empty())) {
+        cerr << "--print_quantiles only applies to a single fit or to streaming mode. It can't be combined with batch, table, summary, binary, model, sweep or daemon modes." << endl;
+        return EXIT_FAILURE;
+    }
+    if(profile && (batch || table || window || decay < 1 || !summary_out_name.empty() || !summary_in_names.empty() ||
+                   !binary_out_name.empty() || !model_in_name.empty() || !daemon_socket.empty())) {
+        cerr << "--profile only applies to a single fit. It can't be combined with batch, table, streaming, summary, binary, model or daemon modes." << endl;
+        return EXIT_FAILURE;
+    }
+    if(sweep_last && score != ScoreType::CHI_SQUARED) {
+        cerr << "--class_count_sweep scores the histograms with the Chi Squared test, so it needs --score chi_squared." << endl;
+        return EXIT_FAILURE;
+    }
+    if(!model_in_name.empty()) {
+        return run_model(model_in_name, out_file_name, generate_output, generate_from_histogram, table_size, print_distribution);
+    }
+    if(!daemon_socket.empty()) {
+        return run_daemon(daemon_socket, settings) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    if(batch) {
+        ofstream report_file;
+        ostream* report = &cout;
+        if(!out_file_name.empty()) {
+            report_file.open(out_file_name);
+            if(!report_file) {
+                cerr << "Error opening " << out_file_name << "." << endl;
+                return EXIT_FAILURE;
+            }
+            report = &report_file;
+        }
+        size_t failures = run_batch(batch_files, settings, *report);
+        if(failures) {
+            cerr << failures << " of " << batch_files.size() << " files couldn't be analysed." << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if(table) {
+        ofstream report_file;
+        ostream* report = &cout;
+        if(!out_file_name.empty()) {
+            report_file.open(out_file_name);
+            if(!report_file) {
+                cerr << "Error opening " << out_file_name << "." << endl;
+                return EXIT_FAILURE;
+            }
+            report = &report_file;
+        }
+        Compression compression = stream_ptr != &cin ? detect_compression(*stream_ptr) : Compression::NONE;
+        if(!compression_supported(compression)) {
+            cerr << in_file_name << " is compressed with " << (compression == Compression::GZIP ? "gzip" : "zstd");
+            cerr << ", which this build can't read." << endl;
+            return EXIT_FAILURE;
+        }
+        //The table is read as text by the read stage of the pipelined reader, which also decompresses it.
+        int fd = in_file_name.empty() ? STDIN_FILENO : open(in_file_name.c_str(), O_RDONLY);
+        if(fd < 0) {
+            cerr << "Error reading " << in_file_name << "." << endl;
+            return EXIT_FAILURE;
+        }
+        size_t failures = 0;
+        bool valid = true;
+        {
+            PipelinedStreamBuf table_buffer(fd);
+            istream table_input(&table_buffer);
+            failures = run_columns(table_input, delimiter, selected_columns, settings, *report);
+            valid = !table_buffer.failed();
+        }
+        if(fd > STDIN_FILENO) {
+            close(fd);
+        }
+        if(!valid) {
+            cerr << "Error reading " << (in_file_name.empty() ? "the standard input" : in_file_name) << "." << endl;
+            return EXIT_FAILURE;
+        }
+        if(failures) {
+            cerr << failures << " columns couldn't be analysed." << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if(window || decay < 1) {
+        ofstream streaming_file;
+        ostream* streaming_output = &cout;
+        if(!out_file_name.empty()) {
+            streaming_file.open(out_file_name);
+            if(!streaming_file) {
+                cerr << "Error opening " << out_file_name << "." << endl;
+                return EXIT_FAILURE;
+            }
+            streaming_output = &streaming_file;
+        }
+        return run_streaming(*stream_ptr, *streaming_output, settings, window, decay, refit_every, print_chi_square_result, quantiles);
+    }
+    bool fixed_edges = class_width > 0 || range_lower < range_upper;
+    if(!summary_out_name.empty() && summary_in_names.empty() && !fixed_edges) {
+        cerr << "Summaries need a histogram with fixed edges. Use --class_width or --histogram_range." << endl;
+        return EXIT_FAILURE;
+    }
+    if(range_lower < range_upper && !class_count) {
+        cerr << "--histogram_range needs the number of classes, supplied with --class_count." << endl;
+        return EXIT_FAILURE;
+    }
+    if(!summary_out_name.empty() && range_lower < range_upper && class_count > max_summary_classes) {
+        cerr << "Summary histograms have at most " << max_summary_classes << " classes. Use a smaller --class_count." << endl;
+        return EXIT_FAILURE;
+    }
+    if(!summary_in_names.empty()) {
+        //Reduce step: the raw data is never read, only the summaries, which are merged and then written or fitted.
+        DataSummary summary;
+        for(const string& name : summary_in_names) {
+            ifstream summary_file(name);
+            DataSummary part;
+            if(!(summary_file >> part)) {
+                cerr << "Error reading summary " << name << "." << endl;
+                return EXIT_FAILURE;
+            }
+            if(!summary.merge(part)) {
+                cerr << "Summary " << name << " has a histogram with different edges and can't be merged." << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        if(!summary.moments().count()) {
+            cerr << "Can't process empty data. The summaries have no samples." << endl;
+            return EXIT_FAILURE;
+        }
+        ofstream out_file;
+        if(!out_file_name.empty()) {
+            out_file.open(out_file_name);
+            if(!out_file) {
+                cerr << "Error opening " << out_file_name << "." << endl;
+                return EXIT_FAILURE;
+            }
+            ostream_ptr = &out_file;
+        }
+        if(!summary_out_name.empty()) {
+            ofstream summary_file(summary_out_name);
+            if(!(summary_file << summary)) {
+                cerr << "Error writing summary " << summary_out_name << "." << endl;
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+        ostream& output = *ostream_ptr;
+        output.precision(numeric_limits<input_data_t>::max_digits10);
+        auto fit = create_distribution(summary, desired_distributions);
+        const SampleMoments& moments = summary.moments();
+        if(print_histogram) {
+            DataHistogram merged_histogram = summary.histogram();
+            output << merged_histogram.print_classes() << endl;
+        }
+        if(print_mean) {
+            output << "Data mean " << moments.mean() << "." << endl;
+        }
+        if(print_var) {
+            output << "Data variance " << moments.variance() << "." << endl;
+        }
+        if(print_std_deviation) {
+            output << "Data standard deviation " << moments.standard_deviation() << "." << endl;
+        }
+        if(print_mode) {
+            output << "Data mode: " << summary.histogram().histogram_mode() << "." << endl;
+        }
+        if(print_min) {
+            output << "Data min value " << moments.min() << "." << endl;
+        }
+        if(print_max) {
+            output << "Data max value " << moments.max() << "." << endl;
+        }
+        if(print_chi_square_result) {
+            output << "Chi square test result for distribution " << fit.first->get_distribution_name() << ": " << fit.second << "." << endl;
+        }
+        if(print_distribution) {
+            output << "Best distribution found: " << fit.first->get_distribution_name() << " with parameters:" << endl;
+            output << fit.first->get_parameters_str() << "." << endl;
+        }
+        for(unsigned int i = 0; i < generate_output; ++i) {
+            output << fit.first->generate_value() << endl;
+        }
+        return EXIT_SUCCESS;
+    }
+    //The holders are created after the flag is set, since their allocators take it when they are created.
+    set_huge_pages_enabled(huge_pages);
+    DataHolder h;
+    SingleDataHolder single_h;
+    //The format and the size are checked on the file itself, since the counting stream used when profiling can't seek.
+    //Standard input may be a pipe, which can't seek either, so it is always text.
+    bool binary = !weighted && stream_ptr != &cin && is_binary_input(*stream_ptr);
+    Compression compression = stream_ptr != &cin ? detect_compression(*stream_ptr) : Compression::NONE;
+    if(!compression_supported(compression)) {
+        cerr << in_file_name << " is compressed with " << (compression == Compression::GZIP ? "gzip" : "zstd");
+        cerr << ", which this build can't read." << endl;
+        return EXIT_FAILURE;
+    }
+    //The density of numbers in compressed bytes says nothing about the sample count.
+    size_t size_hint = binary || compression != Compression::NONE ? 0 : estimate_sample_count(*stream_ptr);
+    Profiler profiler;
+    Profiler* profiler_ptr = profile ? &profiler : nullptr;
+    profile_counters::profiling_enabled = profile;
+    //When profiling, the input is read through a buffer that counts the bytes.
+    unique_ptr<CountingStreamBuf> counting_buffer(profile ? new CountingStreamBuf(stream_ptr->rdbuf()) : nullptr);
+    istream counted_input(counting_buffer.get());
+    istream& input = profile ? counted_input : *stream_ptr;
+    //Summaries keep their statistics in double precision anyway, so single precision only applies to fits.
+    bool single = single_precision && summary_out_name.empty();
+    //Only fits of files are cached: their content can be hashed before reading it, and they have nothing to write but the report.
+    string cache_path;
+    FitCacheEntry cached;
+    bool cache_hit = false;
+    if(!cache_dir.empty() && !in_file_name.empty() && binary_out_name.empty() && summary_out_name.empty() && !sweep_last) {
+        Profiler::ScopedPhase phase(profiler_ptr, "cache_lookup");
+        uint64_t content_hash = 0;
+        if(hash_file(in_file_name, content_hash)) {
+            cache_path = fit_cache_path(cache_dir, content_hash, settings, single, weighted);
+            cache_hit = load_fit_cache(cache_path, cached);
+        }
+        //An entry saved without a requested quantile is refreshed by a normal run.
+        for(input_data_t probability : quantiles) {
+            bool found = false;
+            for(auto& quantile : cached.quantiles) {
+                found = found || quantile.first == probability;
+            }
+            cache_hit = cache_hit && found;
+        }
+    }
+    if(!cache_hit) {
+        Profiler::ScopedPhase phase(profiler_ptr, "read_input");
+        if(binary) {
+            if(!(single ? read_binary(input, single_h) : read_binary(input, h))) {
+                cerr << "Invalid binary input. The file ends before the sample count of its header or has an unknown sample size." << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(weighted) {
+            //Pairs are rare enough in practice that the plain stream reader is good enough for them.
+            if(compression != Compression::NONE) {
+                cerr << "--weighted reads plain text only. Decompress " << in_file_name << " first." << endl;
+                return EXIT_FAILURE;
+            }
+            if(single) {
+                read_weighted(input, single_h);
+            }
+            else {
+                read_weighted(input, h);
+            }
+        }
+        else {
+            //Text is read by the pipelined reader, straight from the file descriptor, so the stream is only used for the estimate.
+            //Fits can take integer data as counts. Binary files and summaries need every sample.
+            int fd = in_file_name.empty() ? STDIN_FILENO : open(in_file_name.c_str(), O_RDONLY);
+            bool valid = fd >= 0;
+            bool count_integers = binary_out_name.empty() && summary_out_name.empty();
+            if(valid && single) {
+                single_h.reserve(size_hint);
+                valid = read_pipelined(fd, single_h, count_integers);
+            }
+            else if(valid) {
+                h.reserve(size_hint);
+                valid = read_pipelined(fd, h, count_integers);
+            }
+            if(fd > STDIN_FILENO) {
+                close(fd);
+            }
+            if(!valid) {
+                cerr << "Error reading " << (in_file_name.empty() ? "the standard input" : in_file_name) << "." << endl;
+                return EXIT_FAILURE;
+            }
         }
     }
-    if(h.begin() == h.end()) {
+    if(!cache_hit && !h.data_size() && !single_h.data_size()) {
         cerr << "Can't process empty data. Please supply floating point values for processing." << endl;
         return EXIT_FAILURE;
     }
-    auto amount_of_data = distance(h.begin(), h.end());
+    if(!binary_out_name.empty()) {
+        ofstream binary_file(binary_out_name, ios::binary);
+        if(!(single ? write_binary(binary_file, single_h) : write_binary(binary_file, h))) {
+            cerr << "Error writing " << binary_out_name << "." << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if(!summary_out_name.empty()) {
+        //Map step: the part of the data set read here is reduced to its summary.
+        DataHistogram histogram;
+        if(class_width > 0) {
+            //The grid has a class per width between the extremes, so a width too small for the range is rejected before allocating.
+            input_data_t grid_classes = floor(h.moments().max() / class_width) - floor(h.moments().min() / class_width) + 1;
+            if(!(grid_classes <= max_summary_classes)) {
+                cerr << "Summary histograms have at most " << max_summary_classes << " classes. A --class_width of " << class_width;
+                cerr << " needs " << grid_classes << " for the range of the data. Use a wider class." << endl;
+                return EXIT_FAILURE;
+            }
+            histogram = DataHistogram::on_grid(h.begin(), h.end(), class_width);
+        }
+        else {
+            histogram = DataHistogram::with_edges(range_lower, range_upper, class_count);
+            histogram.insert(h.begin(), h.end());
+        }
+        ofstream summary_file(summary_out_name);
+        if(!(summary_file << DataSummary(h.moments(), move(histogram)))) {
+            cerr << "Error writing summary " << summary_out_name << "." << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+    if(sweep_last) {
+        size_t samples = single ? single_h.sample_count() : h.sample_count();
+        if(sweep_last > samples) {
+            cerr << "Too many classes for amount of data. Classes: " << sweep_last << " Data: " << samples << endl;
+            return EXIT_FAILURE;
+        }
+        ofstream sweep_file;
+        if(!out_file_name.empty()) {
+            sweep_file.open(out_file_name);
+            if(!sweep_file) {
+                cerr << "Error opening " << out_file_name << "." << endl;
+                return EXIT_FAILURE;
+            }
+            ostream_ptr = &sweep_file;
+        }
+        if(single) {
+            write_sweep(single_h, settings, sweep_first, sweep_last, *ostream_ptr, profiler_ptr);
+        }
+        else {
+            write_sweep(h, settings, sweep_first, sweep_last, *ostream_ptr, profiler_ptr);
+        }
+        return profile && !write_profile(profiler, profile_file_name) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    //Selection reorders the samples, which no later step cares about, so it runs in place instead of on a copy.
+    vector<input_data_t> quantile_values;
+    if(cache_hit) {
+        for(input_data_t probability : quantiles) {
+            for(auto& quantile : cached.quantiles) {
+                if(quantile.first == probability) {
+                    quantile_values.push_back(quantile.second);
+                    break;
+                }
+            }
+        }
+    }
+    else if(!quantiles.empty() && (single ? single_h.is_weighted() : h.is_weighted())) {
+        Profiler::ScopedPhase phase(profiler_ptr, "quantiles");
+        quantile_values = single ? weighted_quantiles(single_h.begin(), single_h.end(), single_h.counts(), quantiles)
+                                 : weighted_quantiles(h.begin(), h.end(), h.counts(), quantiles);
+    }
+    else if(!quantiles.empty()) {
+        Profiler::ScopedPhase phase(profiler_ptr, "quantiles");
+        quantile_values = single ? select_quantiles(single_h.begin(), single_h.end(), quantiles) : select_quantiles(h.begin(), h.end(), quantiles);
+    }
+    size_t amount_of_data = cache_hit ? static_cast<size_t>(cached.moments.total_weight()) : single ? single_h.sample_count() : h.sample_count();
     if(class_count > amount_of_data) {
         cerr << "Too many classes for amount of data. Classes: " << class_count << " Data: " << amount_of_data << endl;
         cerr << "Falling back to default." << endl;
         class_count = 0;
+        settings.class_count = 0;
+    }
+    unique_ptr<InputAnalyser> analyser;
+    FitResult fit_result;
+    if(cache_hit) {
+        fit_result.distribution = cached.distribution;
+        fit_result.score = cached.score;
+        fit_result.candidates = cached.candidates;
+    }
+    else {
+        Profiler::ScopedPhase phase(profiler_ptr, "fit");
+        if(single) {
+            auto fit = create_distribution(single_h, settings.distributions, settings.class_count, settings.score, settings.estimation,
+                                           settings.max_iterations, profiler_ptr, &fit_result.candidates);
+            fit_result.distribution = move(fit.first);
+            fit_result.score = fit.second;
+        }
+        else {
+            analyser.reset(new InputAnalyser(settings, move(h)));
+            fit_result = analyser->fit(profiler_ptr);
+        }
+    }
+    SampleMoments moments = cache_hit ? cached.moments : single ? single_h.moments() : analyser->data().moments();
+    shared_ptr<const Distribution> distr_ptr = fit_result.distribution;
+    input_data_t chi_result = fit_result.score;
+    DataHistogram monte_carlo;
+    input_data_t data_log_likelihood = numeric_limits<input_data_t>::quiet_NaN();
+    if(cache_hit) {
+        monte_carlo = cached.histogram;
+        data_log_likelihood = cached.log_likelihood;
+    }
+    else {
+        Profiler::ScopedPhase phase(profiler_ptr, "report_histogram_build");
+        monte_carlo = single ? single_h.generate_histogram(class_count) : analyser->data().generate_histogram(class_count);
+        if(score == ScoreType::AIC || score == ScoreType::BIC) {
+            data_log_likelihood = single ? log_likelihood(single_h, *distr_ptr) : log_likelihood(analyser->data(), *distr_ptr);
+        }
+    }
+    if(!cache_path.empty() && !cache_hit) {
+        FitCacheEntry entry;
+        entry.distribution = distr_ptr;
+        entry.score = chi_result;
+        entry.log_likelihood = data_log_likelihood;
+        entry.moments = moments;
+        entry.histogram = monte_carlo;
+        entry.candidates = fit_result.candidates;
+        for(size_t i = 0; i < quantile_values.size(); ++i) {
+            entry.quantiles.emplace_back(quantiles[i], quantile_values[i]);
+        }
+        if(!save_fit_cache(cache_path, entry)) {
+            cerr << "Error writing cache entry " << cache_path << "." << endl;
+        }
     }
-    unique_ptr<Distribution> distr_ptr;
-    input_data_t chi_result;
-    tie(distr_ptr, chi_result) = create_distribution(h, desired_distributions, class_count);
-    DataHistogram monte_carlo = h.generate_histogram(class_count);
     if(file.is_open()) {
         file.close();
     }
+    if(!model_out_name.empty()) {
+        DistributionModel model;
+        model.distribution = distr_ptr;
+        model.histogram = HistogramSampler(monte_carlo);
+        ofstream model_file(model_out_name, ios::binary);
+        if(!write_model(model_file, model)) {
+            cerr << "Error writing model " << model_out_name << "." << endl;
+            return EXIT_FAILURE;
+        }
+    }
     ofstream out_file;
     if(!out_file_name.empty()) {
-        out_file.open(out_file_name);
+        out_file.open(out_file_name, format == ReportFormat::BINARY ? ios::out | ios::binary : ios::out);
         if(!out_file) {
             cerr << "Error opening " << out_file_name << "." << endl;
             return EXIT_FAILURE;
@@ -239,6 +1118,37 @@ int main(int argc, char **argv) {
     }
     ostream& output = *ostream_ptr;
     output.precision(numeric_limits<input_data_t>::max_digits10);
+    if(format != ReportFormat::TEXT) {
+        //The structured reports always carry everything, so the print options don't apply.
+        FitReport report;
+        report.distribution = distr_ptr;
+        report.score = chi_result;
+        report.score_type = score;
+        report.candidates = fit_result.candidates;
+        report.log_likelihood = data_log_likelihood;
+        report.p_value = numeric_limits<input_data_t>::quiet_NaN();
+        if(score == ScoreType::KOLMOGOROV_SMIRNOV) {
+            report.p_value = kolmogorov_smirnov_p_value(chi_result, static_cast<size_t>(moments.total_weight()));
+        }
+        report.moments = moments;
+        report.histogram = monte_carlo;
+        for(size_t i = 0; i < quantile_values.size(); ++i) {
+            report.quantiles.emplace_back(quantiles[i], quantile_values[i]);
+        }
+        {
+            Profiler::ScopedPhase phase(profiler_ptr, "generation");
+            generate_values(distr_ptr, monte_carlo, generate_from_histogram, table_size, generate_output, [&report](input_data_t value) {
+                report.generated.push_back(value);
+            });
+        }
+        Profiler::ScopedPhase phase(profiler_ptr, "report");
+        if(!(format == ReportFormat::JSON ? write_json_report(output, report) : write_binary_report(output, report))) {
+            cerr << "Error writing the report." << endl;
+            return EXIT_FAILURE;
+        }
+        return profile && !write_profile(profiler, profile_file_name) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    unique_ptr<Profiler::ScopedPhase> report_phase(new Profiler::ScopedPhase(profiler_ptr, "report"));
     if(print_histogram) {
         output << monte_carlo.print_classes() << endl;
         output << "Histogram mean: " << monte_carlo.histogram_mean() << "." << endl;
@@ -248,25 +1158,38 @@ int main(int argc, char **argv) {
         output << "Histogram max value: " << monte_carlo.histogram_max_value() << "." << endl;
     }
     if(print_mean) {
-        output << "Data mean " << h.mean() << "." << endl;
+        output << "Data mean " << moments.mean() << "." << endl;
     }
     if(print_var) {
-        output << "Data variance " << h.variance() << "." << endl;
+        output << "Data variance " << moments.variance() << "." << endl;
     }
     if(print_std_deviation) {
-        output << "Data standard deviation " << h.standard_deviation() << "." << endl;
+        output << "Data standard deviation " << moments.standard_deviation() << "." << endl;
     }
     if(print_mode) {
         output << "Data mode: " << monte_carlo.histogram_mode() << "." << endl;
     }
     if(print_min) {
-        output << "Data min value " << h.min() << "." << endl;
+        output << "Data min value " << moments.min() << "." << endl;
     }
     if(print_max) {
-        output << "Data max value " << h.max() << "." << endl;
+        output << "Data max value " << moments.max() << "." << endl;
+    }
+    for(size_t i = 0; i < quantile_values.size(); ++i) {
+        output << "Quantile " << quantile_name(quantiles[i]) << ": " << quantile_values[i] << "." << endl;
     }
     if(print_chi_square_result) {
-        output << "Chi square test result for distribution " << distr_ptr->get_distribution_name() << ": " << chi_result << "." << endl;
+        if(score == ScoreType::CHI_SQUARED) {
+            output << "Chi square test result for distribution " << distr_ptr->get_distribution_name() << ": " << chi_result << "." << endl;
+        }
+        else if(score == ScoreType::KOLMOGOROV_SMIRNOV) {
+            output << "Kolmogorov-Smirnov D statistic for distribution " << distr_ptr->get_distribution_name() << ": " << chi_result << "." << endl;
+            output << "Kolmogorov-Smirnov approximate p-value: " << kolmogorov_smirnov_p_value(chi_result, static_cast<size_t>(moments.total_weight())) << "." << endl;
+        }
+        else {
+            output << (score == ScoreType::AIC ? "AIC" : "BIC") << " for distribution " << distr_ptr->get_distribution_name() << ": " << chi_result << "." << endl;
+            output << "Log-likelihood for distribution " << distr_ptr->get_distribution_name() << ": " << data_log_likelihood << "." << endl;
+        }
     }
     if(print_frequency_difference) {
         output << "Frequency differences between chosen distribution and supplied data:" << endl;
@@ -285,14 +1208,177 @@ int main(int argc, char **argv) {
         output << "Best distribution found: " << distr_ptr->get_distribution_name() << " with parameters:" << endl;
         output << distr_ptr->get_parameters_str() << "." << endl;
     }
+    report_phase.reset();
     if(generate_output) {
-        for(unsigned int i = 0; i < generate_output; ++i) {
-            output << distr_ptr->generate_value() << endl;
+        Profiler::ScopedPhase phase(profiler_ptr, "generation");
+        generate_values(distr_ptr, monte_carlo, generate_from_histogram, table_size, generate_output, [&output](input_data_t value) {
+            output << value << endl;
+        });
+    }
+    return profile && !write_profile(profiler, profile_file_name) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+template<typename Sink>
+void generate_values(shared_ptr<const Distribution> distribution, const DataHistogram& histogram, bool from_histogram,
+                     unsigned int table_size, unsigned int count, Sink sink) {
+    if(!count) {
+        return;
+    }
+    if(from_histogram) {
+        HistogramSampler sampler(histogram);
+        RandomEngine& engine = thread_random_engine();
+        for(unsigned int i = 0; i < count; ++i) {
+            sink(sampler.generate_value(engine));
+        }
+        return;
+    }
+    if(table_size) {
+        distribution = tabulate(distribution, table_size);
+    }
+    for(unsigned int i = 0; i < count; ++i) {
+        sink(distribution->generate_value());
+    }
+}
+
+bool write_profile(const Profiler& profiler, const std::string& file_name) {
+    if(file_name.empty()) {
+        profiler.write_json(cerr);
+        return true;
+    }
+    ofstream profile_file(file_name);
+    if(!profile_file) {
+        cerr << "Error opening " << file_name << "." << endl;
+        return false;
+    }
+    profiler.write_json(profile_file);
+    return true;
+}
+
+template<typename T>
+void write_sweep(const BasicDataHolder<T>& data, const AnalyserSettings& settings, std::size_t first, std::size_t last,
+                 std::ostream& output, Profiler* profiler) {
+    //The base histogram has many classes per class of the coarsest resolution, so the merged classes have nearly equal widths.
+    const size_t fine_per_class = 64;
+    size_t fine = std::max(last, std::min(last * fine_per_class, data.sample_count()));
+    DataHistogram base;
+    {
+        Profiler::ScopedPhase phase(profiler, "histogram_build");
+        base = data.generate_histogram(fine);
+    }
+    auto results = sweep_class_counts(data, settings.distributions, base, first, last, settings.estimation, settings.max_iterations,
+                                      profiler);
+    output.precision(numeric_limits<input_data_t>::max_digits10);
+    output << "classes\tdistribution\tparameters\tscore" << endl;
+    for(size_t i = 0; i < results.size(); ++i) {
+        output << first + i << "\t" << results[i].first->get_distribution_name() << "\t" << results[i].first->get_parameters_str();
+        output << "\t" << results[i].second << "\n";
+    }
+    output.flush();
+}
+
+std::string quantile_name(input_data_t probability) {
+    //The outputs print with full precision, which would show 0.99 as 0.98999999999999999.
+    ostringstream name;
+    name << probability;
+    return name.str();
+}
+
+int run_streaming(std::istream& input, std::ostream& output, const AnalyserSettings& settings, std::size_t window, input_data_t decay,
+                  std::size_t refit_every, bool print_chi_square_result, const std::vector<input_data_t>& quantiles) {
+    StreamingAnalyser analyser(settings, window, decay, refit_every);
+    //The quantiles of a stream are estimated in constant memory, over every sample seen.
+    vector<P2Quantile> estimators(quantiles.begin(), quantiles.end());
+    output.precision(numeric_limits<input_data_t>::max_digits10);
+    std::string token;
+    input_data_t value = 0;
+    //Samples are never stored, each one goes straight into the running summaries.
+    while(input >> token) {
+        if(!parse_input_value(token, value)) {
+            continue;
+        }
+        for(P2Quantile& estimator : estimators) {
+            estimator.add(value);
+        }
+        if(!analyser.add(value)) {
+            continue;
+        }
+        const FitResult& fit = analyser.last_fit();
+        if(fit.distribution) {
+            output << "After " << analyser.samples_seen() << " samples: " << fit.distribution->get_distribution_name() << " (";
+            output << fit.distribution->get_parameters_str() << ")";
+            if(print_chi_square_result) {
+                output << ", chi square " << fit.score;
+            }
+            for(const P2Quantile& estimator : estimators) {
+                output << ", quantile " << quantile_name(estimator.probability()) << " " << estimator.value();
+            }
+            output << "." << endl;
+        }
+    }
+    if(!analyser.samples_seen()) {
+        cerr << "Can't process empty data. Please supply floating point values for processing." << endl;
+        return EXIT_FAILURE;
+    }
+    FitResult fit = analyser.refit();
+    if(!fit.distribution) {
+        cerr << "Not enough data for the first fit. Supply at least " << refit_every << " samples or a smaller --refit_every." << endl;
+        return EXIT_FAILURE;
+    }
+    for(const P2Quantile& estimator : estimators) {
+        output << "Quantile " << quantile_name(estimator.probability()) << ": " << estimator.value() << "." << endl;
+    }
+    output << "Best distribution found: " << fit.distribution->get_distribution_name() << " with parameters:" << endl;
+    output << fit.distribution->get_parameters_str() << "." << endl;
+    return EXIT_SUCCESS;
+}
+
+int run_model(const std::string& model_name, const std::string& out_file_name, unsigned int generate_output, bool from_histogram,
+              unsigned int table_size, bool print_distribution) {
+    DistributionModel model;
+    ifstream model_file(model_name, ios::binary);
+    if(!read_model(model_file, model)) {
+        cerr << "Error reading model " << model_name << "." << endl;
+        return EXIT_FAILURE;
+    }
+    if(from_histogram && model.histogram.empty()) {
+        cerr << "Model " << model_name << " has no histogram to generate values from." << endl;
+        return EXIT_FAILURE;
+    }
+    ofstream out_file;
+    ostream* output_ptr = &cout;
+    if(!out_file_name.empty()) {
+        out_file.open(out_file_name);
+        if(!out_file) {
+            cerr << "Error opening " << out_file_name << "." << endl;
+            return EXIT_FAILURE;
         }
+        output_ptr = &out_file;
+    }
+    ostream& output = *output_ptr;
+    output.precision(numeric_limits<input_data_t>::max_digits10);
+    if(print_distribution) {
+        output << "Best distribution found: " << model.distribution->get_distribution_name() << " with parameters:" << endl;
+        output << model.distribution->get_parameters_str() << "." << endl;
+    }
+    if(generate_output && table_size && !from_histogram) {
+        model.distribution = tabulate(model.distribution, table_size);
+    }
+    RandomEngine& engine = thread_random_engine();
+    for(unsigned int i = 0; i < generate_output; ++i) {
+        output << (from_histogram ? model.histogram.generate_value(engine) : model.distribution->generate_value(engine)) << endl;
     }
     return EXIT_SUCCESS;
 }
 
+shared_ptr<const Distribution> tabulate(shared_ptr<const Distribution> distribution, unsigned int table_size) {
+    auto tabulated = make_shared<TabulatedDistribution>(move(distribution), table_size);
+    if(tabulated->table_size()) {
+        cerr << "Inverse cumulative distribution table of " << tabulated->table_size() << " cells, maximum error ";
+        cerr << tabulated->max_error() << "." << endl;
+    }
+    return tabulated;
+}
+
 void print_help(std::ostream& os) {
     os << "Input analyser for statistical purposes." << endl;
     os << "================================================================================" << endl;
@@ -301,11 +1387,106 @@ void print_help(std::ostream& os) {
     os << "--input_file or -if filename: opens filename for processing, which should" << endl;
     os << "contain a list of float values. If not supplied, the user can enter numbers by" << endl;
     os << "hand when the software starts. When done typing numbers, just press ^D twice." << endl;
+    os << "Files compressed with gzip or zstd are decompressed as they are read." << endl;
+    os << "--weighted or -w: the input is pre-aggregated, a value and how many times it" << endl;
+    os << "was observed per line, separated by spaces, tabs or a comma. The fit, the" << endl;
+    os << "scores and the quantiles are the same as on the expanded samples. Only plain" << endl;
+    os << "text single fits are supported." << endl;
     os << "--output_file or -of filename: opens filename to output results." << endl;
+    os << "--format or -fmt text|json|binary: format of the report. json writes one" << endl;
+    os << "object with the parameters as numbers, the score of every candidate, the" << endl;
+    os << "moments, the quantiles, the histogram classes and the generated values." << endl;
+    os << "binary writes the same in the compact format described in src/fitreport.h." << endl;
+    os << "Both ignore the print options. Defaults to text." << endl;
     os << "--generate_random or -gr number: generates number random values using the" << endl;
     os << "best distribution found." << endl; 
     os << "--class_count or -cc number: chooses number as the number of classes for monte" << endl;
     os << "carlo." << endl;
+    os << "--class_count_sweep or -ccs first:last: fits the data once and scores it with" << endl;
+    os << "every class count from first to last, writing a tab separated report with a" << endl;
+    os << "line per class count. The histograms are merged from one fine histogram, so" << endl;
+    os << "the samples are binned once. Needs the chi_squared score." << endl;
+    os << "--score or -sc name: chooses the criterion used to rank the distributions." << endl;
+    os << "chi_squared (default) uses the Chi Squared test on the histogram. likelihood or" << endl;
+    os << "aic uses the Akaike information criterion and bic the Bayesian information" << endl;
+    os << "criterion, both computed from the log-likelihood of every sample. ks uses the" << endl;
+    os << "Kolmogorov-Smirnov D statistic, which needs no histogram." << endl;
+    os << "--estimator or -est name: chooses how the parameters are estimated. moments" << endl;
+    os << "(default) uses the method of moments and mle uses maximum likelihood, starting" << endl;
+    os << "from the moment estimates. The bounds of the triangular are not searched:" << endl;
+    os << "they are the sample extremes widened by range / (samples - 1)." << endl;
+    os << "--mle_max_iterations or -mmi number: maximum number of iterations of the" << endl;
+    os << "maximum likelihood estimators that have no closed form. Defaults to 100." << endl;
+    os << "--daemon or -d path: instead of reading the input, serves fit and generate" << endl;
+    os << "requests for any number of datasets over a Unix domain socket at path. The" << endl;
+    os << "protocol is described in src/analyserdaemon.h. The distribution, score and" << endl;
+    os << "estimator options apply to every fit." << endl;
+    os << "--precision or -prec float|double: precision used to store the samples." << endl;
+    os << "float halves the memory and the memory traffic of the fit. Statistics and" << endl;
+    os << "parameters are always computed in double. Defaults to double." << endl;
+    os << "--huge_pages or -hp: stores the samples in transparent huge pages, which" << endl;
+    os << "makes the passes over big inputs cheaper. Linux only." << endl;
+    os << "--write_binary or -wb file: instead of fitting, writes the input samples to" << endl;
+    os << "file in the binary input format, with the sample size of --precision. Binary" << endl;
+    os << "files given to --input_file are detected and read much faster than text." << endl;
+    os << "--cache_dir or -cd directory: caches fits of --input_file in directory, keyed" << endl;
+    os << "by a hash of the file content and of the settings that change the fit. A later" << endl;
+    os << "run on the same content and settings prints the cached result without reading" << endl;
+    os << "or fitting the data." << endl;
+    os << "--save_model or -sm file: writes the fitted model, the best distribution and" << endl;
+    os << "an alias table of the histogram, to file in a compact binary format." << endl;
+    os << "--load_model or -lm file: instead of reading and fitting data, loads a model" << endl;
+    os << "written by --save_model, prints it and generates the --generate_random values." << endl;
+    os << "--generate_from_histogram or -gh: the random values follow the histogram of" << endl;
+    os << "the data, or of the model, instead of the best distribution." << endl;
+    os << "--tabulate or -tab number: generates the random values by inverse transform" << endl;
+    os << "sampling on a table of the inverse cumulative distribution function with" << endl;
+    os << "number cells, which is cheaper than the exact generators. The maximum error of" << endl;
+    os << "the table, in probability, is written to the standard error." << endl;
+    os << "--batch or -b pattern: batch mode. Analyses every file matching pattern" << endl;
+    os << "(quote it to keep the shell from expanding it) concurrently, and writes one" << endl;
+    os << "tab separated report with a line per file. Can be repeated. Files are read" << endl;
+    os << "like --input_file: binary, compressed or plain text." << endl;
+    os << "--batch_list or -bl file: batch mode with the files listed in file, one per" << endl;
+    os << "line. Can be combined with --batch." << endl;
+    os << "--columns or -col: the input is a table, such as a CSV or TSV file. Every" << endl;
+    os << "column is fitted, in parallel, and the result is a tab separated report with" << endl;
+    os << "a line per column. A first line that isn't numeric names the columns. The" << endl;
+    os << "table may be compressed with gzip or zstd." << endl;
+    os << "--delimiter or -dl character: field delimiter of the table. Use tab for tabs." << endl;
+    os << "Defaults to the first of tab, comma and semicolon in the first line." << endl;
+    os << "--column or -cl name: fits only this column, given by name or position" << endl;
+    os << "starting at 1. Can be repeated." << endl;
+    os << "--threads or -j number: number of threads of the fit, or of the batch and" << endl;
+    os << "table modes. Defaults to the number of hardware threads." << endl;
+    os << "--write_summary or -ws file: instead of fitting, writes a summary of the" << endl;
+    os << "input to file. Summaries of parts of a data set can be merged and fitted" << endl;
+    os << "later. Needs --class_width or --histogram_range." << endl;
+    os << "--read_summary or -rs file: reads and merges a summary instead of reading" << endl;
+    os << "data. Can be repeated. The merged summary is fitted with the Chi Squared test," << endl;
+    os << "or written to the file of --write_summary." << endl;
+    os << "--class_width or -cw width: summary histograms use classes of this width," << endl;
+    os << "with edges on multiples of it, so any two of them can be merged. At most" << endl;
+    os << "1048576 classes may cover the range of the data." << endl;
+    os << "--histogram_range or -hr lower:upper: summary histograms use --class_count" << endl;
+    os << "classes between lower and upper. Values outside go to the edge classes." << endl;
+    os << "--window or -win number: streaming mode. Only the last number samples are" << endl;
+    os << "used, and the best distribution is refit and printed every --refit_every" << endl;
+    os << "samples, from summaries updated as samples enter and leave the window." << endl;
+    os << "--decay or -dec factor: streaming mode where, instead of a window, the weight of" << endl;
+    os << "every sample is multiplied by factor, in (0, 1), for each new sample." << endl;
+    os << "--refit_every or -rfe number: samples between refits in streaming mode." << endl;
+    os << "Defaults to 1000. The first refit_every samples also set the histogram range." << endl;
+    os << "--profile or -prof to write the time spent on each phase and some counters" << endl;
+    os << "(pdf evaluations, integration steps, allocations and bytes read) as JSON to" << endl;
+    os << "the standard error. Only available for single fits and --class_count_sweep." << endl;
+    os << "--profile_file or -proff filename: same as --profile, but writes the JSON to" << endl;
+    os << "filename." << endl;
+    os << "--print_quantiles or -pq p1,p2,...: prints the quantiles of the data, e.g." << endl;
+    os << "0.5,0.99,0.999 for the median and the 99th and 99.9th percentiles. They are" << endl;
+    os << "exact, found by selection instead of sorting. In streaming mode they are" << endl;
+    os << "estimates over every sample seen, in constant memory. Only available for" << endl;
+    os << "single fits and streaming mode." << endl;
     os << "--print_histogram or -ph if the user wants the classes calculated on the" << endl;
     os << "histogram to be printed." << endl;
     os << "--print_mean or -pmn if the user wants the mean calculated on the histogram to" << endl;
@@ -317,7 +1498,7 @@ void print_help(std::ostream& os) {
     os << "--print_min or -pmin if the user wants to print the minimum value." << endl;
     os << "--print_max or -pmax if the user wants to print the maximum value." << endl; 
     os << "--print_chi_square_result or -pcs to print best fit distribution chi squared" << endl;
-    os << "test result." << endl;
+    os << "test result (or its score and log-likelihood when using another --score)." << endl;
     os << "--print_frequency_difference or -pfd to print the difference between the data" << endl;
     os << "frequency and the distribution frequency." << endl;
     os << "--print_all or -pa to print everything. Even if this option is set, it is still" << endl; 
@@ -19,32 +19,101 @@
 #include "mathutils.h"
 #include <random>
 #include <limits>
+#include <algorithm>
+#include "taskpool.h"
 
 using namespace std;
 
-//These variables are made global to this file to preserve state (not sure if necessary).
-//Also they're implemented in an unamed namespace so they can't be accessed from outside.
-namespace {
-    random_device rd;
-    mt19937 mt(rd());
-    uniform_real_distribution<input_data_t> dist(nextafter(numeric_limits<input_data_t>::min(), static_cast<input_data_t>(1.0)), 1);
-}
-
-input_data_t box_muller_transform(input_data_t mean, input_data_t standard_deviation) {
+input_data_t box_muller_transform(RandomEngine& engine, input_data_t mean, input_data_t standard_deviation) {
     //Implementation of a normal random number generator using the Box-Muller transform. 
     //Link: https://en.wikipedia.org/wiki/Box%E2%80%93Muller_transform
-    static bool generate = true;
-    static input_data_t z0, z1;
-    //If generate is false, it means we calculated both z0 and z1 on a previous iteration, so we just use z1.
-    if(!generate) {
-        generate = true;
-        return z1 * standard_deviation + mean;
+    //The transform gives two independent values. The engine keeps the second one for its next call.
+    input_data_t spare = 0;
+    if(engine.take_spare_normal(spare)) {
+        return spare * standard_deviation + mean;
     }
-    //It is guaranteed that dist(mt) will never be 0, since its limit is set to the minimum positive float point + 1.
-    input_data_t random1 = dist(mt);
-    input_data_t random2 = dist(mt);
-    z0 = sqrt(static_cast<input_data_t>(-2.0) * log(random1)) * cos(2 * M_PI * random2);
-    z1 = sqrt(static_cast<input_data_t>(-2.0) * log(random1)) * sin(2 * M_PI * random2);
-    generate = false;
+    //The lower limit is the minimum positive float point, so random1 is never 0.
+    uniform_real_distribution<input_data_t> dist(nextafter(numeric_limits<input_data_t>::min(), static_cast<input_data_t>(1.0)), 1);
+    input_data_t random1 = dist(engine);
+    input_data_t random2 = dist(engine);
+    input_data_t radius = sqrt(static_cast<input_data_t>(-2.0) * log(random1));
+    input_data_t z0 = radius * cos(2 * M_PI * random2);
+    engine.keep_spare_normal(radius * sin(2 * M_PI * random2));
     return z0 * standard_deviation + mean;
 }
+
+input_data_t regularized_gamma_q(input_data_t a, input_data_t x) {
+    //Series and continued fraction of Numerical Recipes, section 6.2. Both need a number of terms in the order of sqrt(a).
+    const input_data_t epsilon = numeric_limits<input_data_t>::epsilon();
+    const input_data_t tiny = numeric_limits<input_data_t>::min() / epsilon;
+    const long max_iterations = 100 + static_cast<long>(20 * sqrt(a));
+    if(x <= 0) {
+        return 1;
+    }
+    input_data_t log_prefactor = a * log(x) - x - lgamma(a);
+    if(x < a + 1) {
+        input_data_t term = 1 / a;
+        input_data_t sum = term;
+        for(long n = 1; n < max_iterations && abs(term) >= abs(sum) * epsilon; ++n) {
+            term *= x / (a + n);
+            sum += term;
+        }
+        return std::max(static_cast<input_data_t>(0), 1 - sum * exp(log_prefactor));
+    }
+    //Modified Lentz's method.
+    input_data_t b = x + 1 - a;
+    input_data_t c = 1 / tiny;
+    input_data_t d = 1 / b;
+    input_data_t h = d;
+    for(long n = 1; n < max_iterations; ++n) {
+        input_data_t an = -n * (n - a);
+        b += 2;
+        d = an * d + b;
+        d = abs(d) < tiny ? tiny : d;
+        c = b + an / c;
+        c = abs(c) < tiny ? tiny : c;
+        d = 1 / d;
+        input_data_t delta = d * c;
+        h *= delta;
+        if(abs(delta - 1) < epsilon) {
+            break;
+        }
+    }
+    return std::min(static_cast<input_data_t>(1), h * exp(log_prefactor));
+}
+
+template<typename T>
+void parallel_sort(vector<T>& data) {
+    //Below this size a plain sort is faster than waking up the threads.
+    const long minimum_chunk = 1 << 16;
+    long sz = data.size();
+    TaskPool& pool = shared_task_pool();
+    long chunks = std::min(static_cast<long>(pool.thread_count()), sz / minimum_chunk);
+    if(chunks < 2) {
+        sort(data.begin(), data.end());
+        return;
+    }
+    vector<long> bounds(chunks + 1);
+    for(long i = 0; i <= chunks; ++i) {
+        bounds[i] = sz / chunks * i + std::min(i, sz % chunks);
+    }
+    auto first = data.begin();
+    parallel_for(pool, 0, chunks, 1, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; ++i) {
+            sort(first + bounds[i], first + bounds[i + 1]);
+        }
+    });
+    //Each round merges pairs of neighbouring sorted runs, doubling the run width.
+    for(long width = 1; width < chunks; width *= 2) {
+        long merges = (chunks - width + 2 * width - 1) / (2 * width);
+        parallel_for(pool, 0, merges, 1, [&](size_t begin, size_t end) {
+            for(size_t merge = begin; merge < end; ++merge) {
+                long i = merge * 2 * width;
+                inplace_merge(first + bounds[i], first + bounds[i + width], first + bounds[std::min(i + 2 * width, chunks)]);
+            }
+        });
+    }
+}
+
+template void parallel_sort(vector<input_data_t>& data);
+template void parallel_sort(vector<single_data_t>& data);
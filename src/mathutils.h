@@ -23,15 +23,39 @@
 #include <algorithm>
 #include <iostream>
 #include "inputtypes.h"
+#include "profiler.h"
+#include "randomengine.h"
 #include <cmath>
+#include <limits>
+#include <vector>
 
 /**
  * Applies Box Muller Transform algorithm to calculate a normal distribution.
+ * Each transform gives two values: the second one is kept in the engine and returned by its next call, so only every other
+ * call draws from the engine.
+ * @param engine The random engine to draw from.
  * @param mean The mean of the desired normal distribution random value.
  * @param standard_deviation The standard deviation of the desired normal distribution random value.
  * @return A random value from the normal distribution with mean = 0, standard deviation = 1 transformed to mean, standard_deviation
  */
-input_data_t box_muller_transform(input_data_t mean, input_data_t standard_deviation);
+input_data_t box_muller_transform(RandomEngine& engine, input_data_t mean, input_data_t standard_deviation);
+
+/**
+ * Sorts the data in ascending order. Each thread sorts a contiguous chunk and then the chunks are merged in parallel, pairwise.
+ * @param data The data to sort.
+ */
+template<typename T>
+void parallel_sort(std::vector<T>& data);
+
+/**
+ * Calculates the regularized upper incomplete gamma function Q(a, x) = Γ(a, x) / Γ(a). For an integer a, it is the probability of a
+ * Poisson variable with mean x being less than a. It uses the series of P(a, x) = 1 - Q(a, x) below x = a + 1 and a continued
+ * fraction above, so the cost grows with the square root of a instead of with a.
+ * @param a The shape. It must be positive.
+ * @param x The point. It must not be negative.
+ * @return Q(a, x).
+ */
+input_data_t regularized_gamma_q(input_data_t a, input_data_t x);
 
 
 //Since this function is templated, we got to implement it in the header.
@@ -56,12 +80,15 @@ input_data_t integral(input_data_t first, input_data_t last, Function fx) {
     input_data_t _first = first, _second = first + step;
     input_data_t sum = 0;
     int iterations = (max - _second) / step;
+    if(iterations > 0 && profile_counters::profiling_enabled.load(std::memory_order_relaxed)) {
+        profile_counters::integration_steps.fetch_add(iterations, std::memory_order_relaxed);
+        profile_counters::pdf_evaluations.fetch_add(2 * static_cast<unsigned long long>(iterations), std::memory_order_relaxed);
+    }
     //Uses the sum of areas of trapezia to calculate the integral of fx.
     //(y0 + y1)/2 * (x1 - x0) + (y1 + y2)/2 * (x2 - x1)...
     //Since (x(n) - x(n-1)) delta x is always equal to step, we don't need to calculate it.
-    #pragma omp parallel for reduction (+:sum)
+    //The loop is about a hundred steps, far too short to pay for a parallel region. Callers parallelize over whole integrals instead.
     for(int i = 0; i < iterations; ++i) {
-        //This is necessary for OpenMP support.
         input_data_t x_first = _first + (i * step);
         input_data_t x_second = _second + (i * step);
         input_data_t y_first = fx(x_first), y_second = fx(x_second);
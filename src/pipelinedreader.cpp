@@ -0,0 +1,426 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "pipelinedreader.h"
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef INPUT_ANALYSER_ZLIB
+#include <zlib.h>
+#endif
+#ifdef INPUT_ANALYSER_ZSTD
+#include <zstd.h>
+#endif
+#include "integercounts.h"
+#include "profiler.h"
+#include "spscring.h"
+
+using namespace std;
+
+namespace {
+    const size_t block_size = 1 << 20;
+    
+    const size_t batch_size = 1 << 16;
+    
+    //A few blocks and batches in flight are enough to absorb the jitter between stages.
+    const size_t ring_capacity = 4;
+    
+    /**
+     * Parses a token that ends at a whitespace or a null character, the way parse_input_value does: the whole token must be the
+     * number and values out of range are rejected.
+     */
+    bool parse_token(const char* first, const char* last, input_data_t& value) {
+        char* end = nullptr;
+        errno = 0;
+        value = strtod(first, &end);
+        return end == last && errno != ERANGE;
+    }
+    
+    bool is_space(char c) {
+        return isspace(static_cast<unsigned char>(c));
+    }
+    
+    const unsigned char gzip_magic[2] = {0x1F, 0x8B};
+    
+    const unsigned char zstd_magic[4] = {0x28, 0xB5, 0x2F, 0xFD};
+    
+    Compression compression_of(const char* data, size_t size) {
+        if(size >= sizeof(gzip_magic) && !memcmp(data, gzip_magic, sizeof(gzip_magic))) {
+            return Compression::GZIP;
+        }
+        if(size >= sizeof(zstd_magic) && !memcmp(data, zstd_magic, sizeof(zstd_magic))) {
+            return Compression::ZSTD;
+        }
+        return Compression::NONE;
+    }
+    
+    /**
+     * Reads until the buffer is full or the input ends.
+     * @return The number of bytes read, or -1 if a read failed.
+     */
+    ssize_t read_full(int fd, char* data, size_t capacity) {
+        size_t size = 0;
+        while(size < capacity) {
+            ssize_t count = read(fd, data + size, capacity - size);
+            if(count < 0 && errno == EINTR) {
+                continue;
+            }
+            if(count < 0) {
+                return -1;
+            }
+            if(!count) {
+                break;
+            }
+            size += count;
+        }
+        if(profile_counters::profiling_enabled) {
+            profile_counters::bytes_read.fetch_add(size, memory_order_relaxed);
+        }
+        return size;
+    }
+    
+    /**
+     * Hands a block to the parser. A block holds its data followed by a null character, so the parser never reads past it.
+     */
+    void push_block(vector<char>& block, size_t size, SpscRing<vector<char>>& blocks) {
+        if(size) {
+            block.resize(size + 1);
+            block[size] = 0;
+            blocks.push(move(block));
+        }
+        block = vector<char>(block_size + 1);
+    }
+    
+#ifdef INPUT_ANALYSER_ZLIB
+    /**
+     * Inflates a gzip input, starting with the raw bytes already read.
+     */
+    bool inflate_blocks(int fd, vector<char>& input, size_t input_size, SpscRing<vector<char>>& blocks) {
+        z_stream stream = z_stream();
+        //15 + 32 takes both the gzip and the zlib headers.
+        if(inflateInit2(&stream, 15 + 32) != Z_OK) {
+            return false;
+        }
+        bool input_done = input_size < block_size;
+        vector<char> block(block_size + 1);
+        stream.next_in = reinterpret_cast<Bytef*>(input.data());
+        stream.avail_in = input_size;
+        stream.next_out = reinterpret_cast<Bytef*>(block.data());
+        stream.avail_out = block_size;
+        bool valid = true;
+        bool member_ended = false;
+        //Output is only certainly complete when a call left room in the output buffer.
+        bool flushed = true;
+        while(valid) {
+            if(!stream.avail_in && flushed) {
+                if(input_done) {
+                    break;
+                }
+                ssize_t count = read_full(fd, input.data(), block_size);
+                valid = count >= 0;
+                input_done = count < static_cast<ssize_t>(block_size);
+                stream.next_in = reinterpret_cast<Bytef*>(input.data());
+                stream.avail_in = std::max<ssize_t>(count, 0);
+                continue;
+            }
+            int status = inflate(&stream, Z_NO_FLUSH);
+            if(status == Z_STREAM_END) {
+                //Concatenated members, as written by pigz or by appending gzip files, are read one after the other.
+                member_ended = true;
+                inflateReset(&stream);
+            }
+            else if(status == Z_OK) {
+                member_ended = false;
+            }
+            else if(status != Z_BUF_ERROR) {
+                valid = false;
+            }
+            flushed = stream.avail_out > 0;
+            if(!flushed) {
+                push_block(block, block_size, blocks);
+                stream.next_out = reinterpret_cast<Bytef*>(block.data());
+                stream.avail_out = block_size;
+            }
+        }
+        push_block(block, block_size - stream.avail_out, blocks);
+        inflateEnd(&stream);
+        //A stream that ends in the middle of a member is truncated.
+        return valid && member_ended;
+    }
+#endif
+    
+#ifdef INPUT_ANALYSER_ZSTD
+    /**
+     * Decompresses a zstd input, starting with the raw bytes already read. Consecutive frames are read one after the other.
+     */
+    bool decompress_zstd_blocks(int fd, vector<char>& input, size_t input_size, SpscRing<vector<char>>& blocks) {
+        ZSTD_DStream* stream = ZSTD_createDStream();
+        if(!stream || ZSTD_isError(ZSTD_initDStream(stream))) {
+            ZSTD_freeDStream(stream);
+            return false;
+        }
+        bool input_done = input_size < block_size;
+        vector<char> block(block_size + 1);
+        ZSTD_inBuffer in = {input.data(), input_size, 0};
+        ZSTD_outBuffer out = {block.data(), block_size, 0};
+        size_t status = 0;
+        bool valid = true;
+        //Output is only certainly complete when a call left room in the output buffer.
+        bool flushed = true;
+        while(valid) {
+            if(in.pos == in.size && flushed) {
+                if(input_done) {
+                    break;
+                }
+                ssize_t count = read_full(fd, input.data(), block_size);
+                valid = count >= 0;
+                input_done = count < static_cast<ssize_t>(block_size);
+                in = {input.data(), static_cast<size_t>(std::max<ssize_t>(count, 0)), 0};
+                continue;
+            }
+            status = ZSTD_decompressStream(stream, &out, &in);
+            valid = !ZSTD_isError(status);
+            flushed = out.pos < out.size;
+            if(!flushed) {
+                push_block(block, block_size, blocks);
+                out = {block.data(), block_size, 0};
+            }
+        }
+        push_block(block, out.pos, blocks);
+        ZSTD_freeDStream(stream);
+        //A non zero hint after the last call means the last frame isn't complete.
+        return valid && !status;
+    }
+#endif
+    
+    /**
+     * The read stage. Compressed inputs are decompressed here, so the parser always gets plain text.
+     */
+    void read_blocks(int fd, SpscRing<vector<char>>& blocks, atomic<bool>& failed) {
+#ifdef POSIX_FADV_SEQUENTIAL
+        //Fails harmlessly on pipes.
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        vector<char> block(block_size + 1);
+        ssize_t size = read_full(fd, block.data(), block_size);
+        bool valid = size >= 0;
+        switch(valid ? compression_of(block.data(), size) : Compression::NONE) {
+            case(Compression::GZIP): {
+#ifdef INPUT_ANALYSER_ZLIB
+                valid = inflate_blocks(fd, block, size, blocks);
+#else
+                valid = false;
+#endif
+                break;
+            }
+            case(Compression::ZSTD): {
+#ifdef INPUT_ANALYSER_ZSTD
+                valid = decompress_zstd_blocks(fd, block, size, blocks);
+#else
+                valid = false;
+#endif
+                break;
+            }
+            default: {
+                while(valid && size == static_cast<ssize_t>(block_size)) {
+                    push_block(block, size, blocks);
+                    size = read_full(fd, block.data(), block_size);
+                    valid = size >= 0;
+                }
+                if(valid) {
+                    push_block(block, size, blocks);
+                }
+                break;
+            }
+        }
+        failed = !valid;
+        blocks.close();
+    }
+    
+    /**
+     * The parse stage. A token cut by the end of a block is carried over to the next one.
+     */
+    template<typename T>
+    void parse_blocks(SpscRing<vector<char>>& blocks, SpscRing<vector<T>>& batches) {
+        vector<T> batch;
+        batch.reserve(batch_size);
+        string carry;
+        vector<char> block;
+        input_data_t value = 0;
+        auto add = [&](input_data_t parsed) {
+            batch.push_back(static_cast<T>(parsed));
+            if(batch.size() == batch_size) {
+                batches.push(move(batch));
+                batch = vector<T>();
+                batch.reserve(batch_size);
+            }
+        };
+        while(blocks.pop(block)) {
+            const char* data = block.data();
+            size_t size = block.size() - 1;
+            size_t i = 0;
+            if(!carry.empty()) {
+                while(i < size && !is_space(data[i])) {
+                    ++i;
+                }
+                carry.append(data, i);
+                if(i == size) {
+                    continue;
+                }
+                if(parse_token(carry.c_str(), carry.c_str() + carry.size(), value)) {
+                    add(value);
+                }
+                carry.clear();
+            }
+            while(true) {
+                while(i < size && is_space(data[i])) {
+                    ++i;
+                }
+                size_t start = i;
+                while(i < size && !is_space(data[i])) {
+                    ++i;
+                }
+                if(i == size) {
+                    carry.assign(data + start, size - start);
+                    break;
+                }
+                if(parse_token(data + start, data + i, value)) {
+                    add(value);
+                }
+            }
+        }
+        if(!carry.empty() && parse_token(carry.c_str(), carry.c_str() + carry.size(), value)) {
+            add(value);
+        }
+        if(!batch.empty()) {
+            batches.push(move(batch));
+        }
+        batches.close();
+    }
+}
+
+Compression detect_compression(istream& is) {
+    char magic[sizeof(zstd_magic)] = {};
+    streampos start = is.tellg();
+    if(start == streampos(-1)) {
+        is.clear();
+        return Compression::NONE;
+    }
+    is.read(magic, sizeof(magic));
+    size_t read = is.gcount();
+    is.clear();
+    is.seekg(start);
+    return compression_of(magic, read);
+}
+
+bool compression_supported(Compression compression) {
+    switch(compression) {
+        case(Compression::GZIP): {
+#ifdef INPUT_ANALYSER_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        }
+        case(Compression::ZSTD): {
+#ifdef INPUT_ANALYSER_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        }
+        default: {
+            return true;
+        }
+    }
+}
+
+template<typename T>
+bool read_pipelined(int fd, BasicDataHolder<T>& holder, bool count_integers) {
+    SpscRing<vector<char>> blocks(ring_capacity);
+    SpscRing<vector<T>> batches(ring_capacity);
+    atomic<bool> failed(false);
+    thread reader(read_blocks, fd, ref(blocks), ref(failed));
+    thread parser(parse_blocks<T>, ref(blocks), ref(batches));
+    IntegerCounts counts;
+    bool counting = count_integers;
+    vector<T> batch;
+    while(batches.pop(batch)) {
+        auto first = batch.begin();
+        if(counting) {
+            while(first != batch.end() && counts.add(*first)) {
+                ++first;
+            }
+            //The first sample that can't be counted ends counting for good.
+            if(first != batch.end()) {
+                counting = false;
+                counts.expand_to(holder);
+            }
+        }
+        holder.append(first, batch.end());
+    }
+    parser.join();
+    reader.join();
+    //Counts only pay off when values repeat. Otherwise the plain samples take less memory than values with their counts.
+    if(counting && 2 * counts.distinct_count() <= counts.sample_count()) {
+        counts.add_to(holder);
+    }
+    else if(counting) {
+        counts.expand_to(holder);
+    }
+    return !failed;
+}
+
+template bool read_pipelined(int fd, BasicDataHolder<input_data_t>& holder, bool count_integers);
+template bool read_pipelined(int fd, BasicDataHolder<single_data_t>& holder, bool count_integers);
+
+PipelinedStreamBuf::PipelinedStreamBuf(int fd): _blocks(ring_capacity), _failed(false) {
+    _reader = thread(read_blocks, fd, ref(_blocks), ref(_failed));
+}
+
+PipelinedStreamBuf::~PipelinedStreamBuf() {
+    while(_blocks.pop(_block)) {
+    }
+    _reader.join();
+}
+
+bool PipelinedStreamBuf::failed() const {
+    return _failed;
+}
+
+PipelinedStreamBuf::int_type PipelinedStreamBuf::underflow() {
+    if(gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    //Every block has at least one character before its terminating null.
+    if(!_blocks.pop(_block)) {
+        return traits_type::eof();
+    }
+    setg(_block.data(), _block.data(), _block.data() + _block.size() - 1);
+    return traits_type::to_int_type(*gptr());
+}
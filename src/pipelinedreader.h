@@ -0,0 +1,116 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef PIPELINEDREADER_H
+#define PIPELINEDREADER_H
+#include <iostream>
+#include <atomic>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include "dataholder.h"
+#include "spscring.h"
+
+/**
+ * Enum listing the compression formats of text inputs.
+ */
+enum class Compression {
+    NONE,
+    GZIP,
+    ZSTD
+};
+
+/**
+ * Detects the compression of an input from its magic number. The stream is left at its current position.
+ * @param is The input stream. It must be able to seek.
+ * @return The compression format, NONE if the stream can't seek.
+ */
+Compression detect_compression(std::istream& is);
+
+/**
+ * Tells if this build can decompress a format. Each format needs its library when building: zlib for gzip and libzstd for zstd.
+ * @param compression The format.
+ * @return true if read_pipelined can read inputs in that format.
+ */
+bool compression_supported(Compression compression);
+
+/**
+ * Reads a text input in three overlapped stages, so the total time approaches the time of the slowest stage instead of their sum:
+ * a thread reads large blocks with read(2), after asking the kernel for sequential readahead; a thread splits them into tokens and
+ * parses them; and the calling thread stores the samples and updates the statistics. The stages are connected by bounded lock-free
+ * rings, so memory use stays constant however fast one stage is. Tokens follow the rules of parse_input_value, and the ones that
+ * aren't numbers are skipped, like with the stream operator of the holder.
+ * Inputs compressed with gzip (including concatenated members) or zstd are detected and decompressed by the read stage, as a stream,
+ * so the decompression runs concurrently with the parsing.
+ * When count_integers is set and every sample is a non-negative integer, as in count series, the samples are counted per value
+ * instead of stored, and the holder receives each distinct value with its count. The holder is then weighted, and its statistics
+ * are the ones of the samples. If a sample isn't an integer, or the values are too many for counting to save memory, the samples
+ * counted so far are expanded and the rest is stored as usual.
+ * @param fd The file descriptor to read, such as 0 for the standard input. It works on pipes too. It isn't closed.
+ * @param holder Receives the samples.
+ * @param count_integers If integer inputs are stored as counts.
+ * @return false if a read failed, or the input is corrupt or compressed in a format this build can't decompress.
+ */
+template<typename T>
+bool read_pipelined(int fd, BasicDataHolder<T>& holder, bool count_integers = false);
+
+extern template bool read_pipelined(int fd, BasicDataHolder<input_data_t>& holder, bool count_integers);
+extern template bool read_pipelined(int fd, BasicDataHolder<single_data_t>& holder, bool count_integers);
+
+/**
+ * Stream buffer over the read stage of read_pipelined, for readers that need the text itself, such as read_columns. The blocks are
+ * read, and decompressed when the input is compressed with gzip or zstd, by a thread while the stream is being parsed.
+ */
+class PipelinedStreamBuf: public std::streambuf {
+public:
+    /**
+     * Constructs an object and starts reading.
+     * @param fd The file descriptor to read. It isn't closed, and it must stay open while this object exists.
+     */
+    explicit PipelinedStreamBuf(int fd);
+    
+    PipelinedStreamBuf(const PipelinedStreamBuf&) = delete;
+    PipelinedStreamBuf& operator=(const PipelinedStreamBuf&) = delete;
+    
+    /**
+     * Destroys the object. The rest of the input is read and discarded, so the read thread can finish.
+     */
+    ~PipelinedStreamBuf();
+    
+    /**
+     * Tells if the input couldn't be read. It is only final once the stream reached its end.
+     * @return true if a read failed, or the input is corrupt or compressed in a format this build can't decompress.
+     */
+    bool failed() const;
+    
+protected:
+    virtual int_type underflow();
+    
+private:
+    SpscRing<std::vector<char>> _blocks;
+    
+    std::vector<char> _block;
+    
+    std::atomic<bool> _failed;
+    
+    std::thread _reader;
+};
+
+#endif // PIPELINEDREADER_H
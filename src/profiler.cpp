@@ -0,0 +1,81 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.h"
+
+using namespace std;
+
+namespace profile_counters {
+    atomic<bool> profiling_enabled(false);
+    atomic<unsigned long long> pdf_evaluations(0);
+    atomic<unsigned long long> cdf_evaluations(0);
+    atomic<unsigned long long> integration_steps(0);
+    atomic<unsigned long long> allocations(0);
+    atomic<unsigned long long> allocated_bytes(0);
+    atomic<unsigned long long> bytes_read(0);
+}
+
+Profiler::ScopedPhase::ScopedPhase(Profiler* profiler, string name): _profiler(profiler), _name(move(name)) {
+    if(_profiler) {
+        _wall_start = chrono::steady_clock::now();
+        _cpu_start = clock();
+    }
+}
+
+Profiler::ScopedPhase::~ScopedPhase() {
+    if(_profiler) {
+        double wall = chrono::duration<double>(chrono::steady_clock::now() - _wall_start).count();
+        double cpu = static_cast<double>(clock() - _cpu_start) / CLOCKS_PER_SEC;
+        _profiler->record_phase(_name, wall, cpu);
+    }
+}
+
+void Profiler::record_phase(const string& name, double wall_seconds, double cpu_seconds) {
+    _phases.push_back({name, wall_seconds, cpu_seconds});
+}
+
+void Profiler::write_json(ostream& os) const {
+    os << "{" << endl << "  \"phases\": [";
+    for(size_t i = 0; i < _phases.size(); ++i) {
+        os << (i ? "," : "") << endl;
+        os << "    {\"name\": \"" << _phases[i].name << "\", \"wall_seconds\": " << _phases[i].wall_seconds;
+        os << ", \"cpu_seconds\": " << _phases[i].cpu_seconds << "}";
+    }
+    os << endl << "  ]," << endl;
+    os << "  \"counters\": {" << endl;
+    os << "    \"pdf_evaluations\": " << profile_counters::pdf_evaluations << "," << endl;
+    os << "    \"cdf_evaluations\": " << profile_counters::cdf_evaluations << "," << endl;
+    os << "    \"integration_steps\": " << profile_counters::integration_steps << "," << endl;
+    os << "    \"allocations\": " << profile_counters::allocations << "," << endl;
+    os << "    \"allocated_bytes\": " << profile_counters::allocated_bytes << "," << endl;
+    os << "    \"bytes_read\": " << profile_counters::bytes_read << endl;
+    os << "  }" << endl << "}" << endl;
+}
+
+CountingStreamBuf::int_type CountingStreamBuf::underflow() {
+    if(gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    streamsize count = _source->sgetn(_buffer, sizeof(_buffer));
+    if(count <= 0) {
+        return traits_type::eof();
+    }
+    profile_counters::bytes_read.fetch_add(count, memory_order_relaxed);
+    setg(_buffer, _buffer, _buffer + count);
+    return traits_type::to_int_type(*gptr());
+}
@@ -0,0 +1,147 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <streambuf>
+
+/**
+ * Process wide counters, updated with relaxed atomic increments only while profiling_enabled is set, so threads don't
+ * share their cache line when nobody reads them.
+ */
+namespace profile_counters {
+    /**
+     * Set to true to update the counters, including the allocations counted by the replaced operator new of
+     * allocationcounter.cpp. Programs that embed the library without that file get no allocation counts.
+     */
+    extern std::atomic<bool> profiling_enabled;
+    
+    /**
+     * Number of probability distribution evaluations, both from integrals and from likelihood passes.
+     */
+    extern std::atomic<unsigned long long> pdf_evaluations;
+    
+    /**
+     * Number of cumulative distribution evaluations.
+     */
+    extern std::atomic<unsigned long long> cdf_evaluations;
+    
+    /**
+     * Number of trapezia summed by integral.
+     */
+    extern std::atomic<unsigned long long> integration_steps;
+    
+    /**
+     * Number of calls to operator new.
+     */
+    extern std::atomic<unsigned long long> allocations;
+    
+    /**
+     * Number of bytes requested to operator new.
+     */
+    extern std::atomic<unsigned long long> allocated_bytes;
+    
+    /**
+     * Number of bytes read from the input.
+     */
+    extern std::atomic<unsigned long long> bytes_read;
+}
+
+/**
+ * Class that records the wall clock and CPU time of the phases of an analysis and reports them as JSON.
+ */
+class Profiler {
+public:
+    /**
+     * RAII helper that times a phase from its construction to its destruction. It does nothing if the profiler is null,
+     * so callers can always create one.
+     */
+    class ScopedPhase {
+    public:
+        /**
+         * Starts timing a phase.
+         * @param profiler The profiler that will receive the phase, or nullptr to disable timing.
+         * @param name The name of the phase.
+         */
+        ScopedPhase(Profiler* profiler, std::string name);
+        
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+        
+        /**
+         * Stops timing and records the phase.
+         */
+        ~ScopedPhase();
+    private:
+        Profiler* _profiler;
+        std::string _name;
+        std::chrono::steady_clock::time_point _wall_start;
+        std::clock_t _cpu_start;
+    };
+    
+    /**
+     * Records a phase.
+     * @param name The name of the phase.
+     * @param wall_seconds Elapsed wall clock time.
+     * @param cpu_seconds Elapsed CPU time of the whole process, summed over all threads.
+     */
+    void record_phase(const std::string& name, double wall_seconds, double cpu_seconds);
+    
+    /**
+     * Writes every recorded phase and the current value of the counters as a JSON object.
+     * @param os The output stream.
+     */
+    void write_json(std::ostream& os) const;
+    
+private:
+    struct phase {
+        std::string name;
+        double wall_seconds;
+        double cpu_seconds;
+    };
+    
+    std::vector<phase> _phases;
+};
+
+/**
+ * Stream buffer that forwards reads to another stream buffer, in big blocks, counting the bytes in profile_counters::bytes_read.
+ */
+class CountingStreamBuf: public std::streambuf {
+public:
+    /**
+     * Constructs an object.
+     * @param source The stream buffer to read from. It must outlive this object.
+     */
+    CountingStreamBuf(std::streambuf* source): _source(source) {}
+    
+protected:
+    virtual int_type underflow();
+    
+private:
+    std::streambuf* _source;
+    
+    char _buffer[1 << 16];
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,102 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "quantiles.h"
+
+using namespace std;
+
+P2Quantile::P2Quantile(input_data_t probability): _probability(probability), _count(0), _heights(), _positions(), _desired(),
+    _increments() {
+    _increments[0] = 0;
+    _increments[1] = probability / 2;
+    _increments[2] = probability;
+    _increments[3] = (1 + probability) / 2;
+    _increments[4] = 1;
+}
+
+void P2Quantile::add(input_data_t value) {
+    //The first five samples are kept sorted and become the initial markers.
+    if(_count < 5) {
+        _heights[_count++] = value;
+        sort(_heights, _heights + _count);
+        if(_count == 5) {
+            for(int i = 0; i < 5; ++i) {
+                _positions[i] = i;
+                _desired[i] = 4 * _increments[i];
+            }
+        }
+        return;
+    }
+    ++_count;
+    int cell = 0;
+    if(value < _heights[0]) {
+        _heights[0] = value;
+    }
+    else if(value >= _heights[4]) {
+        _heights[4] = value;
+        cell = 3;
+    }
+    else {
+        while(value >= _heights[cell + 1]) {
+            ++cell;
+        }
+    }
+    for(int i = cell + 1; i < 5; ++i) {
+        _positions[i] += 1;
+    }
+    for(int i = 0; i < 5; ++i) {
+        _desired[i] += _increments[i];
+    }
+    //The three middle markers move at most one position towards where they should be, adjusting their heights.
+    for(int i = 1; i < 4; ++i) {
+        input_data_t offset = _desired[i] - _positions[i];
+        if((offset >= 1 && _positions[i + 1] - _positions[i] > 1) || (offset <= -1 && _positions[i - 1] - _positions[i] < -1)) {
+            input_data_t step = offset > 0 ? 1 : -1;
+            input_data_t left_gap = _positions[i] - _positions[i - 1];
+            input_data_t right_gap = _positions[i + 1] - _positions[i];
+            input_data_t parabolic = _heights[i] + step / (_positions[i + 1] - _positions[i - 1]) *
+                                     ((left_gap + step) * (_heights[i + 1] - _heights[i]) / right_gap +
+                                      (right_gap - step) * (_heights[i] - _heights[i - 1]) / left_gap);
+            if(_heights[i - 1] < parabolic && parabolic < _heights[i + 1]) {
+                _heights[i] = parabolic;
+            }
+            else {
+                int neighbour = i + static_cast<int>(step);
+                _heights[i] += step * (_heights[neighbour] - _heights[i]) / (_positions[neighbour] - _positions[i]);
+            }
+            _positions[i] += step;
+        }
+    }
+}
+
+input_data_t P2Quantile::value() const {
+    if(!_count) {
+        return numeric_limits<input_data_t>::quiet_NaN();
+    }
+    if(_count <= 5) {
+        //Same interpolation as select_quantiles.
+        input_data_t position = _probability * (_count - 1);
+        size_t low = static_cast<size_t>(floor(position));
+        if(low + 1 >= _count) {
+            return _heights[_count - 1];
+        }
+        return _heights[low] + (position - low) * (_heights[low + 1] - _heights[low]);
+    }
+    return _heights[2];
+}
@@ -0,0 +1,179 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QUANTILES_H
+#define QUANTILES_H
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include "inputtypes.h"
+
+/**
+ * Computes exact quantiles by selection, in O(n) expected time per quantile instead of the O(n log n) of a sort.
+ * Quantiles between two samples are interpolated linearly, with the sample at position (n - 1) * p taken as the quantile p.
+ * The range is reordered, but keeps the same values, so it can be used in place on data whose order doesn't matter.
+ * @param first Iterator to the first sample.
+ * @param last Iterator to one past the last sample.
+ * @param probabilities The quantiles to compute, each in [0, 1].
+ * @return The quantiles, in the order of probabilities, or NaNs if the range is empty.
+ */
+template<typename Iterator>
+std::vector<input_data_t> select_quantiles(Iterator first, Iterator last, const std::vector<input_data_t>& probabilities);
+
+/**
+ * Computes exact quantiles of pre-aggregated samples, giving the same result as select_quantiles on the expanded data.
+ * The samples are copied and sorted, so the ranges are left untouched and stay aligned.
+ * @param first Iterator to the first distinct value.
+ * @param last Iterator to one past the last distinct value.
+ * @param counts Iterator to how many times the first value was observed, followed by the counts of the others.
+ * @param probabilities The quantiles to compute, each in [0, 1].
+ * @return The quantiles, in the order of probabilities, or NaNs if the total count is zero.
+ */
+template<typename Iterator, typename CountIterator>
+std::vector<input_data_t> weighted_quantiles(Iterator first, Iterator last, CountIterator counts, const std::vector<input_data_t>& probabilities);
+
+/**
+ * Constant memory streaming estimator of one quantile, with the P² algorithm of Jain and Chlamtac. It keeps five markers whose
+ * heights follow a piecewise parabolic approximation of the cumulative function, so each sample costs O(1).
+ */
+class P2Quantile {
+public:
+    //Constructors
+    
+    /**
+     * Constructs an estimator with no samples.
+     * @param probability The quantile to estimate, in [0, 1].
+     */
+    explicit P2Quantile(input_data_t probability);
+    
+    /**
+     * Adds a sample.
+     * @param value The sample.
+     */
+    void add(input_data_t value);
+    
+    /**
+     * Gets the estimate. It is exact while there are at most five samples.
+     * @return The estimated quantile, or NaN if there is no sample.
+     */
+    input_data_t value() const;
+    
+    /**
+     * Gets the quantile being estimated.
+     * @return The probability supplied to the constructor.
+     */
+    input_data_t probability() const {
+        return _probability;
+    }
+    
+private:
+    input_data_t _probability;
+    
+    std::size_t _count;
+    
+    input_data_t _heights[5];
+    
+    input_data_t _positions[5];
+    
+    input_data_t _desired[5];
+    
+    input_data_t _increments[5];
+};
+
+//Since it is a templated function, we implement it in the header.
+template<typename Iterator>
+std::vector<input_data_t> select_quantiles(Iterator first, Iterator last, const std::vector<input_data_t>& probabilities) {
+    std::vector<input_data_t> result(probabilities.size(), std::numeric_limits<input_data_t>::quiet_NaN());
+    std::size_t sz = std::distance(first, last);
+    if(!sz) {
+        return result;
+    }
+    //The quantiles are selected in ascending order, each one only in the part of the range not yet partitioned.
+    std::vector<std::size_t> order(probabilities.size());
+    for(std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&probabilities](std::size_t left, std::size_t right) {
+        return probabilities[left] < probabilities[right];
+    });
+    Iterator begin = first;
+    for(std::size_t index : order) {
+        input_data_t p = std::min(std::max(probabilities[index], static_cast<input_data_t>(0.0)), static_cast<input_data_t>(1.0));
+        input_data_t position = p * (sz - 1);
+        std::size_t low = static_cast<std::size_t>(std::floor(position));
+        Iterator nth = first + low;
+        if(nth >= begin) {
+            std::nth_element(begin, nth, last);
+            begin = nth;
+        }
+        input_data_t value = *nth;
+        input_data_t fraction = position - low;
+        if(fraction > 0 && low + 1 < sz) {
+            //Everything after nth is not smaller than it, so the next order statistic is the minimum of that part.
+            input_data_t next = *std::min_element(nth + 1, last);
+            value += fraction * (next - value);
+        }
+        result[index] = value;
+    }
+    return result;
+}
+
+template<typename Iterator, typename CountIterator>
+std::vector<input_data_t> weighted_quantiles(Iterator first, Iterator last, CountIterator counts, const std::vector<input_data_t>& probabilities) {
+    std::vector<input_data_t> result(probabilities.size(), std::numeric_limits<input_data_t>::quiet_NaN());
+    std::vector<std::pair<input_data_t, std::size_t>> sorted;
+    std::size_t total = 0;
+    for(; first != last; ++first, ++counts) {
+        sorted.emplace_back(static_cast<input_data_t>(*first), static_cast<std::size_t>(*counts));
+        total += *counts;
+    }
+    if(!total) {
+        return result;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    //Finds the value at a position of the expanded data by walking the cumulative counts.
+    auto order_statistic = [&sorted](std::size_t position) {
+        std::size_t below = 0;
+        for(const auto& entry : sorted) {
+            below += entry.second;
+            if(position < below) {
+                return entry.first;
+            }
+        }
+        return sorted.back().first;
+    };
+    for(std::size_t index = 0; index < probabilities.size(); ++index) {
+        input_data_t p = std::min(std::max(probabilities[index], static_cast<input_data_t>(0.0)), static_cast<input_data_t>(1.0));
+        input_data_t position = p * (total - 1);
+        std::size_t low = static_cast<std::size_t>(std::floor(position));
+        input_data_t value = order_statistic(low);
+        input_data_t fraction = position - low;
+        if(fraction > 0 && low + 1 < total) {
+            value += fraction * (order_statistic(low + 1) - value);
+        }
+        result[index] = value;
+    }
+    return result;
+}
+
+#endif // QUANTILES_H
@@ -0,0 +1,89 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RANDOMENGINE_H
+#define RANDOMENGINE_H
+#include <random>
+#include <type_traits>
+#include "inputtypes.h"
+
+/**
+ * The pseudo random number engine used by every generator: a std::mt19937 that also holds the second normal value of the last
+ * Box-Muller transform, for the next transform with this engine. Seeding drops it, so the values only depend on the seed and on
+ * the calls made with the engine.
+ */
+class RandomEngine: public std::mt19937 {
+public:
+    using std::mt19937::mt19937;
+    
+    RandomEngine(): std::mt19937() {}
+    
+    /**
+     * Seeds the engine and drops the spare normal value.
+     * @param value The seed.
+     */
+    void seed(result_type value = default_seed) {
+        std::mt19937::seed(value);
+        _has_spare_normal = false;
+    }
+    
+    /**
+     * Seeds the engine from a seed sequence and drops the spare normal value.
+     * @param sequence The seed sequence.
+     */
+    template<typename SeedSequence, typename = typename std::enable_if<!std::is_convertible<SeedSequence, result_type>::value>::type>
+    void seed(SeedSequence& sequence) {
+        std::mt19937::seed(sequence);
+        _has_spare_normal = false;
+    }
+    
+    /**
+     * Takes the spare standard normal value, if there is one.
+     * @param value Receives the value.
+     * @return false if there was no spare value.
+     */
+    bool take_spare_normal(input_data_t& value) {
+        value = _spare_normal;
+        bool had_spare = _has_spare_normal;
+        _has_spare_normal = false;
+        return had_spare;
+    }
+    
+    /**
+     * Keeps a standard normal value for the next take_spare_normal.
+     * @param value The value.
+     */
+    void keep_spare_normal(input_data_t value) {
+        _spare_normal = value;
+        _has_spare_normal = true;
+    }
+    
+private:
+    input_data_t _spare_normal = 0;
+    
+    bool _has_spare_normal = false;
+};
+
+/**
+ * Gets an engine owned by the calling thread. It is seeded from std::random_device the first time each thread asks for it,
+ * so there is no shared state between threads and no seeding cost for threads that never generate values.
+ * @return The engine of the calling thread.
+ */
+RandomEngine& thread_random_engine();
+
+#endif // RANDOMENGINE_H
@@ -0,0 +1,172 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "samplemoments.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    //Weighted Welford update, shared by the plain and the log statistics.
+    void add_weighted(input_data_t value, input_data_t weight, input_data_t& total_weight, input_data_t& mean, input_data_t& m2) {
+        total_weight += weight;
+        input_data_t delta = value - mean;
+        mean += delta * weight / total_weight;
+        m2 += weight * delta * (value - mean);
+    }
+    
+    //Exact inverse of add_weighted.
+    void remove_weighted(input_data_t value, input_data_t weight, input_data_t& total_weight, input_data_t& mean, input_data_t& m2) {
+        input_data_t new_weight = total_weight - weight;
+        if(new_weight <= 0) {
+            total_weight = 0;
+            mean = 0;
+            m2 = 0;
+            return;
+        }
+        input_data_t old_mean = (total_weight * mean - weight * value) / new_weight;
+        m2 -= weight * (value - old_mean) * (value - mean);
+        m2 = std::max(m2, static_cast<input_data_t>(0.0));
+        mean = old_mean;
+        total_weight = new_weight;
+    }
+    
+    //Chan's pairwise combination of two weighted Welford states.
+    void merge_weighted(input_data_t other_weight, input_data_t other_mean, input_data_t other_m2, input_data_t& total_weight,
+                        input_data_t& mean, input_data_t& m2) {
+        if(other_weight <= 0) {
+            return;
+        }
+        input_data_t new_weight = total_weight + other_weight;
+        input_data_t delta = other_mean - mean;
+        mean += delta * other_weight / new_weight;
+        m2 += other_m2 + delta * delta * total_weight * other_weight / new_weight;
+        total_weight = new_weight;
+    }
+}
+
+void SampleMoments::add(input_data_t value, input_data_t weight) {
+    ++_count;
+    add_weighted(value, weight, _weight, _mean, _m2);
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+    if(value > 0) {
+        ++_positive_count;
+        add_weighted(log(value), weight, _log_weight, _log_mean, _log_m2);
+    }
+}
+
+void SampleMoments::remove(input_data_t value, input_data_t weight) {
+    if(!_count) {
+        return;
+    }
+    --_count;
+    remove_weighted(value, weight, _weight, _mean, _m2);
+    if(value > 0 && _positive_count) {
+        --_positive_count;
+        remove_weighted(log(value), weight, _log_weight, _log_mean, _log_m2);
+    }
+}
+
+void SampleMoments::merge(const SampleMoments& other) {
+    _count += other._count;
+    merge_weighted(other._weight, other._mean, other._m2, _weight, _mean, _m2);
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+    _positive_count += other._positive_count;
+    merge_weighted(other._log_weight, other._log_mean, other._log_m2, _log_weight, _log_mean, _log_m2);
+}
+
+void SampleMoments::scale(input_data_t factor) {
+    _weight *= factor;
+    _m2 *= factor;
+    _log_weight *= factor;
+    _log_m2 *= factor;
+}
+
+input_data_t SampleMoments::mean() const {
+    if(!_count) {
+        return numeric_limits<input_data_t>::quiet_NaN();
+    }
+    return _mean;
+}
+
+input_data_t SampleMoments::variance() const {
+    if(!_count) {
+        return numeric_limits<input_data_t>::quiet_NaN();
+    }
+    if(_weight <= 1) {
+        return 0;
+    }
+    return _m2 / (_weight - 1);
+}
+
+input_data_t SampleMoments::population_variance() const {
+    if(!_count) {
+        return numeric_limits<input_data_t>::quiet_NaN();
+    }
+    return _m2 / _weight;
+}
+
+input_data_t SampleMoments::standard_deviation() const {
+    return sqrt(variance());
+}
+
+input_data_t SampleMoments::log_mean() const {
+    if(!_positive_count) {
+        return numeric_limits<input_data_t>::quiet_NaN();
+    }
+    return _log_mean;
+}
+
+input_data_t SampleMoments::log_population_variance() const {
+    if(!_positive_count) {
+        return numeric_limits<input_data_t>::quiet_NaN();
+    }
+    return _log_m2 / _log_weight;
+}
+
+input_data_t SampleMoments::log_variance() const {
+    if(!_positive_count) {
+        return numeric_limits<input_data_t>::quiet_NaN();
+    }
+    if(_log_weight <= 1) {
+        return 0;
+    }
+    return _log_m2 / (_log_weight - 1);
+}
+
+ostream& operator<<(ostream& os, const SampleMoments& moments) {
+    auto precision = os.precision(numeric_limits<input_data_t>::max_digits10);
+    os << moments._count << " " << moments._weight << " " << moments._mean << " " << moments._m2 << " " << moments._min << " ";
+    os << moments._max << " " << moments._positive_count << " " << moments._log_weight << " " << moments._log_mean << " ";
+    os << moments._log_m2;
+    os.precision(precision);
+    return os;
+}
+
+istream& operator>>(istream& is, SampleMoments& moments) {
+    SampleMoments read;
+    is >> read._count >> read._weight >> read._mean >> read._m2 >> read._min >> read._max >> read._positive_count;
+    is >> read._log_weight >> read._log_mean >> read._log_m2;
+    if(is) {
+        moments = read;
+    }
+    return is;
+}
@@ -0,0 +1,204 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SAMPLEMOMENTS_H
+#define SAMPLEMOMENTS_H
+#include <cstddef>
+#include <limits>
+#include <iostream>
+#include "inputtypes.h"
+
+/**
+ * Class that accumulates the sufficient statistics of a stream of samples in constant memory.
+ * Mean and variance are updated with West's weighted version of Welford's algorithm, so adding or removing a sample is O(1)
+ * and numerically stable. Unweighted samples have weight 1, and then every statistic is the usual one.
+ * The statistics of the logarithm of the positive samples are kept too, since the lognormal estimators need them.
+ */
+class SampleMoments {
+public:
+    //Constructors
+    
+    /**
+     * Constructs an object with no samples.
+     */
+    SampleMoments(): _count(0), _weight(0), _mean(0), _m2(0), _min(std::numeric_limits<input_data_t>::max()),
+                     _max(-std::numeric_limits<input_data_t>::max()), _positive_count(0), _log_weight(0), _log_mean(0), _log_m2(0) {}
+    
+    /**
+     * Adds a sample.
+     * @param value The new sample.
+     * @param weight The weight of the sample.
+     * @pre <strong class="paramname">weight</strong> > 0.
+     */
+    void add(input_data_t value, input_data_t weight = 1);
+    
+    /**
+     * Removes a sample that was added before, with the same weight. The extremes are not updated, since that can't be done
+     * in constant time. Callers that remove samples must track them and use set_extremes.
+     * @param value The sample.
+     * @param weight The weight it was added with.
+     */
+    void remove(input_data_t value, input_data_t weight = 1);
+    
+    /**
+     * Multiplies the weight of every sample added so far by factor. It is how exponentially decayed statistics are kept:
+     * scale by the decay factor, then add the new sample with weight 1.
+     * @param factor The factor.
+     * @pre 0 < <strong class="paramname">factor</strong>.
+     */
+    void scale(input_data_t factor);
+    
+    /**
+     * Adds every sample of other, as if they had been added to this object. The result is the same, up to rounding, as adding
+     * all the samples to one object, so statistics computed on parts of a data set can be combined.
+     * @param other The statistics to merge.
+     */
+    void merge(const SampleMoments& other);
+    
+    /**
+     * Overrides the extremes.
+     * @param min The new minimum.
+     * @param max The new maximum.
+     */
+    void set_extremes(input_data_t min, input_data_t max) {
+        _min = min;
+        _max = max;
+    }
+    
+    /**
+     * Returns the number of samples.
+     * @return The number of samples added and not removed.
+     */
+    std::size_t count() const {
+        return _count;
+    }
+    
+    /**
+     * Returns the sum of the weights.
+     * @return The total weight, which is equal to count() for unweighted samples.
+     */
+    input_data_t total_weight() const {
+        return _weight;
+    }
+    
+    /**
+     * Gets the mean of the samples.
+     * @return The mean or NaN if there is no sample.
+     */
+    input_data_t mean() const;
+    
+    /**
+     * Gets the sample variance, using the total weight - 1 as the denominator.
+     * @return The variance, 0 if the total weight is at most 1 or NaN if there is no sample.
+     */
+    input_data_t variance() const;
+    
+    /**
+     * Gets the population variance, using the total weight as the denominator. This is the maximum likelihood estimate.
+     * @return The variance or NaN if there is no sample.
+     */
+    input_data_t population_variance() const;
+    
+    /**
+     * Gets the sample standard deviation.
+     * @return The standard deviation, 0 if the total weight is at most 1 or NaN if there is no sample.
+     */
+    input_data_t standard_deviation() const;
+    
+    /**
+     * Gets the minimum sample.
+     * @return The minimum sample or the biggest representable value if there is no sample.
+     */
+    input_data_t min() const {
+        return _min;
+    }
+    
+    /**
+     * Gets the maximum sample.
+     * @return The maximum sample or the lowest representable value if there is no sample.
+     */
+    input_data_t max() const {
+        return _max;
+    }
+    
+    /**
+     * Returns the number of samples greater than 0.
+     * @return The amount of samples that have a logarithm.
+     */
+    std::size_t positive_count() const {
+        return _positive_count;
+    }
+    
+    /**
+     * Gets the mean of the logarithm of the positive samples.
+     * @return The mean of the logs or NaN if there is no positive sample.
+     */
+    input_data_t log_mean() const;
+    
+    /**
+     * Gets the population variance of the logarithm of the positive samples.
+     * @return The variance of the logs or NaN if there is no positive sample.
+     */
+    input_data_t log_population_variance() const;
+    
+    /**
+     * Gets the sample variance of the logarithm of the positive samples, using their total weight - 1 as the denominator.
+     * @return The variance of the logs, 0 if their total weight is at most 1 or NaN if there is no positive sample.
+     */
+    input_data_t log_variance() const;
+    
+    /**
+     * Writes the state of the object, in a format read back by operator>>. Values are written with enough digits to be read back
+     * exactly.
+     * @param os The output stream.
+     * @param moments The object to write.
+     * @return The output stream <strong class="paramname">os</strong>
+     */
+    friend std::ostream& operator<<(std::ostream& os, const SampleMoments& moments);
+    
+    /**
+     * Reads a state written by operator<<. On a malformed input, sets the failbit of the stream and leaves the object untouched.
+     * @param is The input stream.
+     * @param moments The object to read into.
+     * @return The input stream <strong class="paramname">is</strong>
+     */
+    friend std::istream& operator>>(std::istream& is, SampleMoments& moments);
+    
+private:
+    std::size_t _count;
+    
+    input_data_t _weight;
+    
+    input_data_t _mean;
+    
+    input_data_t _m2;
+    
+    input_data_t _min;
+    
+    input_data_t _max;
+    
+    std::size_t _positive_count;
+    
+    input_data_t _log_weight;
+    
+    input_data_t _log_mean;
+    
+    input_data_t _log_m2;
+};
+
+#endif // SAMPLEMOMENTS_H
@@ -0,0 +1,104 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Bounded lock-free queue between exactly one producer thread and one consumer thread. Each side only writes its own index, so
+ * a push or a pop is a couple of atomic loads and one release store. The blocking versions yield while they wait.
+ */
+template<typename T>
+class SpscRing {
+public:
+    /**
+     * Constructs an empty, open ring.
+     * @param capacity The minimum number of elements it holds. It is rounded up to a power of 2.
+     */
+    explicit SpscRing(std::size_t capacity): _head(0), _tail(0), _closed(false) {
+        std::size_t size = 2;
+        while(size < capacity) {
+            size *= 2;
+        }
+        _slots.resize(size);
+        _mask = size - 1;
+    }
+    
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    
+    /**
+     * Adds an element, waiting while the ring is full. Only called by the producer.
+     * @param value The element.
+     */
+    void push(T value) {
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+        while(tail - _head.load(std::memory_order_acquire) == _slots.size()) {
+            std::this_thread::yield();
+        }
+        _slots[tail & _mask] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+    }
+    
+    /**
+     * Takes the oldest element, waiting while the ring is empty and open. Only called by the consumer.
+     * @param value Receives the element.
+     * @return false if the ring is closed and empty.
+     */
+    bool pop(T& value) {
+        std::size_t head = _head.load(std::memory_order_relaxed);
+        while(head == _tail.load(std::memory_order_acquire)) {
+            //The producer closes after its last push, so the tail is checked again once the ring is seen closed.
+            if(_closed.load(std::memory_order_acquire) && head == _tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        value = std::move(_slots[head & _mask]);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * Tells the consumer no more elements will come. Only called by the producer.
+     */
+    void close() {
+        _closed.store(true, std::memory_order_release);
+    }
+    
+private:
+    std::vector<T> _slots;
+    
+    std::size_t _mask;
+    
+    //The indices only grow. Each one is written by a single side and lives on its own cache line.
+    alignas(64) std::atomic<std::size_t> _head;
+    
+    alignas(64) std::atomic<std::size_t> _tail;
+    
+    alignas(64) std::atomic<bool> _closed;
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,200 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "streaminganalyser.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+StreamingAnalyser::StreamingAnalyser(AnalyserSettings settings, size_t window_size, input_data_t decay, size_t refit_every):
+    _settings(move(settings)), _window_size(window_size), _decay(decay), _refit_every(std::max(refit_every, static_cast<size_t>(1))),
+    _seen(0), _started(false), _lower(0), _step(0), _total_weight(0), _inflation(1), _accounted(0),
+    _last_fit({nullptr, numeric_limits<input_data_t>::quiet_NaN(), {}}) {
+    if(_settings.distributions.empty()) {
+        _settings.distributions.insert(DistributionType::TRIANGULAR);
+        _settings.distributions.insert(DistributionType::NORMAL);
+        _settings.distributions.insert(DistributionType::UNIFORM);
+        _settings.distributions.insert(DistributionType::EXPONENTIAL);
+        _settings.distributions.insert(DistributionType::LOGNORMAL);
+        _settings.distributions.insert(DistributionType::POISSON);
+    }
+}
+
+void StreamingAnalyser::set_bounds(input_data_t lower, input_data_t upper) {
+    if(!_started) {
+        _start(lower, upper);
+    }
+}
+
+bool StreamingAnalyser::add(input_data_t value) {
+    ++_seen;
+    if(!_started) {
+        _warm_up.push_back(value);
+        if(_warm_up.size() < _refit_every) {
+            return false;
+        }
+        auto min_max = minmax_element(_warm_up.begin(), _warm_up.end());
+        input_data_t margin = (*min_max.second - *min_max.first) / 2;
+        if(margin <= 0) {
+            margin = std::abs(*min_max.first) / 2 + 1;
+        }
+        _start(*min_max.first - margin, *min_max.second + margin);
+        refit();
+        return true;
+    }
+    _account(value);
+    if(_seen % _refit_every == 0) {
+        refit();
+        return true;
+    }
+    return false;
+}
+
+void StreamingAnalyser::_start(input_data_t lower, input_data_t upper) {
+    //Same default as the histogram, the square root of the sample size, using the effective size of the decayed samples.
+    input_data_t effective_size = _window_size ? _window_size : (_decay < 1 ? 1 / (1 - _decay) : _refit_every);
+    size_t classes = _settings.class_count;
+    if(!classes) {
+        classes = std::min(std::max(static_cast<size_t>(sqrt(effective_size)), static_cast<size_t>(1)), static_cast<size_t>(100));
+    }
+    _lower = lower;
+    _step = (upper - lower) / classes;
+    _counts.assign(classes, 0);
+    if(_window_size) {
+        _window.reserve(_window_size);
+    }
+    _started = true;
+    for(input_data_t value: _warm_up) {
+        _account(value);
+    }
+    _warm_up.clear();
+    _warm_up.shrink_to_fit();
+}
+
+size_t StreamingAnalyser::_class_of(input_data_t value) const {
+    input_data_t position = floor((value - _lower) / _step);
+    if(!(position > 0)) {
+        return 0;
+    }
+    return std::min(static_cast<size_t>(position), _counts.size() - 1);
+}
+
+void StreamingAnalyser::_account(input_data_t value) {
+    size_t index = _accounted++;
+    if(_window_size) {
+        if(_window.size() == _window_size) {
+            input_data_t& slot = _window[index % _window_size];
+            _moments.remove(slot);
+            _counts[_class_of(slot)] -= 1;
+            _total_weight -= 1;
+            slot = value;
+        }
+        else {
+            _window.push_back(value);
+        }
+        _moments.add(value);
+        _counts[_class_of(value)] += 1;
+        _total_weight += 1;
+        //The queues keep, in order, the only samples that can still become the extreme of some future window.
+        while(!_min_queue.empty() && _min_queue.back().second >= value) {
+            _min_queue.pop_back();
+        }
+        _min_queue.push_back(make_pair(index, value));
+        while(!_max_queue.empty() && _max_queue.back().second <= value) {
+            _max_queue.pop_back();
+        }
+        _max_queue.push_back(make_pair(index, value));
+        while(index - _min_queue.front().first >= _window_size) {
+            _min_queue.pop_front();
+        }
+        while(index - _max_queue.front().first >= _window_size) {
+            _max_queue.pop_front();
+        }
+        _moments.set_extremes(_min_queue.front().second, _max_queue.front().second);
+        return;
+    }
+    _moments.scale(_decay);
+    _moments.add(value);
+    _inflation /= _decay;
+    _counts[_class_of(value)] += _inflation;
+    _total_weight += _inflation;
+    //Renormalizes before the inflated counts overflow.
+    if(_inflation > 1e100) {
+        for(input_data_t& count: _counts) {
+            count /= _inflation;
+        }
+        _total_weight /= _inflation;
+        _inflation = 1;
+    }
+}
+
+input_data_t StreamingAnalyser::_score(const vector<input_data_t>& probabilities) const {
+    input_data_t total = _total_weight / _inflation;
+    input_data_t sum = 0;
+    for(size_t i = 0; i < _counts.size(); ++i) {
+        input_data_t expected = probabilities[i] * total;
+        input_data_t observed = _counts[i] / _inflation;
+        if(!(expected > 0)) {
+            if(observed > 0) {
+                return numeric_limits<input_data_t>::infinity();
+            }
+            continue;
+        }
+        sum += (expected - observed) * (expected - observed) / expected;
+    }
+    return sum;
+}
+
+FitResult StreamingAnalyser::refit() {
+    if(!_started || !_moments.count()) {
+        return _last_fit;
+    }
+    FitResult best = {nullptr, numeric_limits<input_data_t>::quiet_NaN(), {}};
+    vector<input_data_t> probabilities(_counts.size());
+    for(DistributionType type: _settings.distributions) {
+        shared_ptr<const Distribution> candidate(estimate_distribution(type, _moments));
+        if(!candidate) {
+            continue;
+        }
+        //The edge classes also hold the clamped samples, so they take the whole tails.
+        input_data_t previous = 0;
+        for(size_t i = 0; i + 1 < _counts.size(); ++i) {
+            input_data_t current = candidate->cumulative_for(_lower + (i + 1) * _step);
+            probabilities[i] = current - previous;
+            previous = current;
+        }
+        probabilities.back() = 1 - previous;
+        input_data_t score = _score(probabilities);
+        if(isnan(best.score) || score < best.score) {
+            best.distribution = candidate;
+            best.score = score;
+            _last_probabilities = probabilities;
+        }
+    }
+    _last_fit = best;
+    return _last_fit;
+}
+
+input_data_t StreamingAnalyser::current_score() const {
+    if(!_last_fit.distribution) {
+        return numeric_limits<input_data_t>::quiet_NaN();
+    }
+    return _score(_last_probabilities);
+}
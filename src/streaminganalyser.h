@@ -0,0 +1,164 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STREAMINGANALYSER_H
+#define STREAMINGANALYSER_H
+#include <vector>
+#include <deque>
+#include <utility>
+#include <cstddef>
+#include "analyser.h"
+#include "samplemoments.h"
+#include "inputtypes.h"
+
+/**
+ * Analyser for unbounded streams. It only looks at the most recent data: either the last window_size samples, or every sample
+ * with a weight that decays exponentially with its age. The moments and the histogram counts are updated incrementally as
+ * samples enter and leave, and the best distribution is refit every refit_every samples from those summaries alone.
+ * Adding a sample costs O(1) and never touches older samples, except for the one leaving the window. A refit costs
+ * O(candidates * classes).
+ * The histogram needs fixed bounds. If none are given, they are taken from the first refit_every samples, widened by half
+ * their range on both sides. Later samples outside the bounds are counted in the first or last class.
+ */
+class StreamingAnalyser {
+public:
+    /**
+     * Constructs an object.
+     * @param settings The fit settings. The score is always the Chi Squared test, since there are no raw samples to compute the others.
+     * @param window_size The number of samples in the window, or 0 to use decay instead.
+     * @param decay The factor multiplying the weight of every sample each time a new sample arrives. Only used if window_size is 0.
+     * @param refit_every The number of samples between refits.
+     * @pre 0 < <strong class="paramname">decay</strong> <= 1.
+     * @pre <strong class="paramname">refit_every</strong> > 0.
+     */
+    StreamingAnalyser(AnalyserSettings settings, std::size_t window_size, input_data_t decay, std::size_t refit_every);
+    
+    /**
+     * Sets the bounds of the histogram, instead of taking them from the first samples. It must be called before the first add.
+     * @param lower The lower bound of the first class.
+     * @param upper The upper bound of the last class.
+     * @pre <strong class="paramname">lower</strong> < <strong class="paramname">upper</strong>.
+     */
+    void set_bounds(input_data_t lower, input_data_t upper);
+    
+    /**
+     * Adds a sample.
+     * @return true if the distribution was refit because of this sample.
+     */
+    bool add(input_data_t value);
+    
+    /**
+     * Refits the best distribution from the current summaries.
+     * @return The best distribution and its Chi Squared score.
+     */
+    FitResult refit();
+    
+    /**
+     * Gets the result of the last refit.
+     * @return The last fit, with a null distribution if there was none yet.
+     */
+    const FitResult& last_fit() const {
+        return _last_fit;
+    }
+    
+    /**
+     * Chi Squared score of the last fit against the current histogram, in O(classes), without refitting.
+     * @return The score, or NaN if there was no fit yet.
+     */
+    input_data_t current_score() const;
+    
+    /**
+     * Gets the moments of the samples in the window, or the decayed moments.
+     * @return The moments.
+     */
+    const SampleMoments& moments() const {
+        return _moments;
+    }
+    
+    /**
+     * Returns the number of samples seen since the construction.
+     * @return The number of samples.
+     */
+    std::size_t samples_seen() const {
+        return _seen;
+    }
+    
+private:
+    /**
+     * Sets up the classes and moves the buffered warm up samples into the summaries.
+     */
+    void _start(input_data_t lower, input_data_t upper);
+    
+    /**
+     * Adds a sample to the summaries.
+     */
+    void _account(input_data_t value);
+    
+    std::size_t _class_of(input_data_t value) const;
+    
+    /**
+     * Chi Squared score of a distribution given the class probabilities.
+     */
+    input_data_t _score(const std::vector<input_data_t>& probabilities) const;
+    
+    AnalyserSettings _settings;
+    
+    std::size_t _window_size;
+    
+    input_data_t _decay;
+    
+    std::size_t _refit_every;
+    
+    std::size_t _seen;
+    
+    bool _started;
+    
+    std::vector<input_data_t> _warm_up;
+    
+    input_data_t _lower;
+    
+    input_data_t _step;
+    
+    std::vector<input_data_t> _counts;
+    
+    input_data_t _total_weight;
+    
+    //Decayed counts are stored multiplied by this factor, which grows by 1 / decay with each sample. That way only the
+    //new sample's class is touched, instead of decaying every class.
+    input_data_t _inflation;
+    
+    //Number of samples moved into the summaries.
+    std::size_t _accounted;
+    
+    SampleMoments _moments;
+    
+    //Ring buffer with the samples in the window.
+    std::vector<input_data_t> _window;
+    
+    //Monotonic queues of (sample index, value) for the window extremes.
+    std::deque<std::pair<std::size_t, input_data_t>> _min_queue;
+    
+    std::deque<std::pair<std::size_t, input_data_t>> _max_queue;
+    
+    FitResult _last_fit;
+    
+    //Class probabilities of the last fit, cached for current_score.
+    std::vector<input_data_t> _last_probabilities;
+};
+
+#endif // STREAMINGANALYSER_H
@@ -0,0 +1,188 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "taskpool.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    //The pool the calling thread works for and its index there, so tasks submitted from tasks stay local.
+    thread_local const TaskPool* current_pool = nullptr;
+    
+    thread_local size_t current_index = 0;
+    
+    //Workers of the shared pool when it is created, 0 for one per hardware thread.
+    atomic<size_t> shared_pool_threads(0);
+}
+
+TaskPool::TaskPool(size_t thread_count): _queued(0), _unfinished(0), _stopping(false), _next_queue(0) {
+    if(!thread_count) {
+        thread_count = std::max(thread::hardware_concurrency(), 1u);
+    }
+    for(size_t i = 0; i < thread_count; ++i) {
+        _queues.emplace_back(new worker_queue());
+    }
+    for(size_t i = 0; i < thread_count; ++i) {
+        _threads.emplace_back(&TaskPool::_run, this, i);
+    }
+}
+
+TaskPool::~TaskPool() {
+    wait();
+    {
+        lock_guard<mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _work_available.notify_all();
+    for(thread& worker : _threads) {
+        worker.join();
+    }
+}
+
+void TaskPool::submit(function<void()> task) {
+    size_t index = current_pool == this ? current_index : _next_queue.fetch_add(1, memory_order_relaxed) % _queues.size();
+    //The counters go up before the task is visible, so a worker can never take a task that isn't counted yet.
+    {
+        lock_guard<mutex> lock(_mutex);
+        ++_queued;
+        ++_unfinished;
+    }
+    {
+        lock_guard<mutex> lock(_queues[index]->mutex);
+        _queues[index]->tasks.push_back(move(task));
+    }
+    _work_available.notify_one();
+}
+
+void TaskPool::wait() {
+    unique_lock<mutex> lock(_mutex);
+    _all_done.wait(lock, [this]() {
+        return !_unfinished;
+    });
+}
+
+bool TaskPool::_take(size_t index, function<void()>& task) {
+    {
+        lock_guard<mutex> lock(_queues[index]->mutex);
+        if(!_queues[index]->tasks.empty()) {
+            task = move(_queues[index]->tasks.back());
+            _queues[index]->tasks.pop_back();
+            return true;
+        }
+    }
+    for(size_t offset = 1; offset < _queues.size(); ++offset) {
+        worker_queue& victim = *_queues[(index + offset) % _queues.size()];
+        lock_guard<mutex> lock(victim.mutex);
+        if(!victim.tasks.empty()) {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskPool::_run(size_t index) {
+    current_pool = this;
+    current_index = index;
+    function<void()> task;
+    while(true) {
+        if(_take(index, task)) {
+            {
+                lock_guard<mutex> lock(_mutex);
+                --_queued;
+            }
+            task();
+            task = nullptr;
+            lock_guard<mutex> lock(_mutex);
+            if(!--_unfinished) {
+                _all_done.notify_all();
+            }
+            continue;
+        }
+        unique_lock<mutex> lock(_mutex);
+        //A task counted but not pushed yet is about to appear, so we only sleep when nothing is queued.
+        _work_available.wait(lock, [this]() {
+            return _queued || _stopping;
+        });
+        if(_stopping && !_queued) {
+            return;
+        }
+    }
+}
+
+TaskPool& shared_task_pool() {
+    static TaskPool pool(shared_pool_threads.load());
+    return pool;
+}
+
+void set_shared_task_pool_threads(size_t thread_count) {
+    shared_pool_threads = thread_count;
+}
+
+void parallel_for(TaskPool& pool, size_t begin, size_t end, size_t grain, const function<void(size_t, size_t)>& body) {
+    if(end <= begin) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (end - begin + grain - 1) / grain;
+    if(chunks == 1 || current_pool || pool.thread_count() == 1) {
+        body(begin, end);
+        return;
+    }
+    //The state is shared with the helpers, since one may only start after the loop is over. It then finds no chunk to take.
+    struct loop_state {
+        atomic<size_t> next;
+        
+        mutex done_mutex;
+        
+        condition_variable all_done;
+        
+        size_t done;
+    };
+    auto state = make_shared<loop_state>();
+    state->next = 0;
+    state->done = 0;
+    const function<void(size_t, size_t)>* body_ptr = &body;
+    auto run_chunks = [state, body_ptr, begin, end, grain, chunks]() {
+        size_t finished = 0;
+        for(size_t chunk = state->next++; chunk < chunks; chunk = state->next++) {
+            size_t first = begin + chunk * grain;
+            (*body_ptr)(first, std::min(first + grain, end));
+            ++finished;
+        }
+        if(finished) {
+            lock_guard<mutex> lock(state->done_mutex);
+            state->done += finished;
+            if(state->done == chunks) {
+                state->all_done.notify_all();
+            }
+        }
+    };
+    size_t helpers = std::min(chunks, pool.thread_count()) - 1;
+    for(size_t i = 0; i < helpers; ++i) {
+        pool.submit(run_chunks);
+    }
+    run_chunks();
+    unique_lock<mutex> lock(state->done_mutex);
+    state->all_done.wait(lock, [&state, chunks]() {
+        return state->done == chunks;
+    });
+}
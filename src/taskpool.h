@@ -0,0 +1,172 @@
+/*
+ * Input analyser for statistical data processing
+ * Copyright (C) 2018  Lucas Finger Roman <lfrfinger@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+/**
+ * A fixed set of worker threads running submitted tasks. Each worker has its own queue: it runs its newest task first and, when its
+ * queue is empty, steals the oldest task of another worker, so uneven tasks still keep every core busy.
+ */
+class TaskPool {
+public:
+    //Constructors
+    
+    /**
+     * Starts the workers.
+     * @param thread_count The number of workers. If 0, one per hardware thread.
+     */
+    explicit TaskPool(std::size_t thread_count = 0);
+    
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+    
+    /**
+     * Waits for every task and stops the workers.
+     */
+    ~TaskPool();
+    
+    /**
+     * Queues a task. Tasks submitted by a worker go to its own queue, others are spread among the workers.
+     * @param task The task. It must not throw.
+     */
+    void submit(std::function<void()> task);
+    
+    /**
+     * Blocks until every submitted task has finished.
+     * @pre Not called from a task.
+     */
+    void wait();
+    
+    /**
+     * Returns the number of workers.
+     * @return The number of workers.
+     */
+    std::size_t thread_count() const {
+        return _threads.size();
+    }
+    
+private:
+    struct worker_queue {
+        std::mutex mutex;
+        
+        std::deque<std::function<void()>> tasks;
+    };
+    
+    std::vector<std::unique_ptr<worker_queue>> _queues;
+    
+    std::vector<std::thread> _threads;
+    
+    std::mutex _mutex;
+    
+    std::condition_variable _work_available;
+    
+    std::condition_variable _all_done;
+    
+    //Tasks waiting in some queue, protected by _mutex.
+    std::size_t _queued;
+    
+    //Tasks submitted and not finished, protected by _mutex.
+    std::size_t _unfinished;
+    
+    bool _stopping;
+    
+    std::atomic<std::size_t> _next_queue;
+    
+    void _run(std::size_t index);
+    
+    bool _take(std::size_t index, std::function<void()>& task);
+};
+
+/**
+ * Number of samples of a chunk in the passes over the data. A chunk of densities is worth hundreds of microseconds, so the task
+ * switch is negligible, while a big data set still has enough chunks for every worker.
+ */
+const std::size_t sample_grain = 1 << 16;
+
+/**
+ * Gets the pool shared by the whole program for coarse grained parallelism, such as the candidates, the classes of a histogram or
+ * chunks of the data. It is created on first use, with the number of workers of set_shared_task_pool_threads, and lives until the
+ * program exits.
+ * @return The shared pool.
+ */
+TaskPool& shared_task_pool();
+
+/**
+ * Sets the number of workers of the shared pool. It only has an effect before the pool is first used.
+ * @param thread_count The number of workers. If 0, one per hardware thread, which is the default.
+ */
+void set_shared_task_pool_threads(std::size_t thread_count);
+
+/**
+ * Runs a loop split in chunks. The calling thread and all but one of the workers of the pool take chunks until there are none left,
+ * so the loop uses as many threads as the pool has workers. A chunk must be worth far more than a task switch, about a microsecond.
+ * Called from a task of any pool, the loop runs serially on the calling thread, since the pool already has all the parallelism it
+ * can use.
+ * @param pool The pool.
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param grain The number of indices of a chunk.
+ * @param body Called with the bounds [first, last) of each chunk. Chunks run concurrently, so they must only write their own results.
+ */
+void parallel_for(TaskPool& pool, std::size_t begin, std::size_t end, std::size_t grain,
+                  const std::function<void(std::size_t, std::size_t)>& body);
+
+/**
+ * Reduces a loop split in chunks with parallel_for. Each chunk gets its own partial result and the partials are combined in the
+ * order of the chunks, so the result doesn't depend on the number of threads.
+ * @param pool The pool.
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param grain The number of indices of a chunk.
+ * @param identity The result of an empty loop.
+ * @param body Called with the bounds [first, last) of each chunk, returns the partial result of the chunk.
+ * @param combine Combines two partial results.
+ * @return The combined result.
+ */
+template<typename R, typename Body, typename Combine>
+R parallel_reduce(TaskPool& pool, std::size_t begin, std::size_t end, std::size_t grain, R identity, const Body& body,
+                  const Combine& combine) {
+    grain = grain ? grain : 1;
+    std::size_t chunks = end > begin ? (end - begin + grain - 1) / grain : 0;
+    std::vector<R> partials(chunks, identity);
+    parallel_for(pool, 0, chunks, 1, [&](std::size_t first, std::size_t last) {
+        for(std::size_t chunk = first; chunk < last; ++chunk) {
+            std::size_t chunk_begin = begin + chunk * grain;
+            partials[chunk] = body(chunk_begin, std::min(chunk_begin + grain, end));
+        }
+    });
+    R result = identity;
+    for(const R& partial : partials) {
+        result = combine(result, partial);
+    }
+    return result;
+}
+
+#endif // TASKPOOL_H